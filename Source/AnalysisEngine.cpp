@@ -0,0 +1,718 @@
+/*
+  ==============================================================================
+
+    AnalysisEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "AnalysisEngine.h"
+
+//==============================================================================
+AnalysisEngine::AnalysisEngine()
+{
+    pathPool.forEachFrame([](CurveFrame& frame) { frame.path.preallocateSpace(6 * FFTSizes::numPoints); });
+}
+AnalysisEngine::~AnalysisEngine()
+{
+    if (backgroundTicking)
+        frameScheduler->removeBackground(*this);
+
+    // a pair's frames are worked on by the leader's job, which reads both engines' rings and pools,
+    // so whichever of the two goes first has to stop that job before its members go
+    unlinkStereo();
+}
+void AnalysisEngine::unlinkStereo()
+{
+    if (stereoLeader != nullptr)
+        stereoLeader->setStereoPartner(nullptr);
+
+    if (stereoPartner != nullptr)
+        setStereoPartner(nullptr);
+}
+void AnalysisEngine::prepare(double sampleRate, int samplesPerBlock)
+{
+    // everything requested so far is read here; a request stored after these loads flags itself again
+    settingsPending.store(false);
+    currentSampleRate = sampleRate;
+    currentFFTOrder = requestedOrder.load();
+    currentMultiResolution = requestedMultiResolution.load();
+    overlap = requestedOverlap.load();
+    frequencyScale = requestedScale.load();
+    aggregation = requestedAggregation.load();
+    updateHopSize();
+
+    // the job reads the ring in place, so it can't be running while the ring is reallocated,
+    // and neither can the job of a leader this engine was paired with
+    unlinkStereo();
+    fftProcessingJob.suspend();
+    fftProcessingJob.prepare(sampleRate, currentFFTOrder, currentMultiResolution, frequencyScale, aggregation);
+    jobIsStale = false;
+    pushing = false;
+
+    // big enough for the largest FFT, since the order can change while we play
+    sampleRing.prepare(juce::jmax(4 << FFTPipeline::maxOrder, 4 * samplesPerBlock));
+
+    // stamps count samples from the start of the ring, so the old ones mean nothing now
+    BlockStamp stamp;
+    while (blockStamps.pull(stamp)) {}
+
+    updateLeaderJob();
+    fftProcessingJob.resume();
+}
+void AnalysisEngine::attach(AnalysisConsumers::Kind kind, double framesPerSecond)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(consumerLock);
+        consumerRates.add(juce::jmax(0.0, framesPerSecond));
+    }
+
+    consumers.counts[(size_t)kind].fetch_add(1);
+    updateLeaderJob();
+
+    // whatever changed while nobody was attached is applied before the first frame the new consumer sees
+    applyPendingSettings();
+    updateBackgroundTick();
+}
+void AnalysisEngine::detach(AnalysisConsumers::Kind kind, double framesPerSecond)
+{
+    jassert(consumers.wants(kind));
+
+    {
+        const juce::SpinLock::ScopedLockType lock(consumerLock);
+        jassert(consumerRates.contains(juce::jmax(0.0, framesPerSecond)));
+        consumerRates.removeFirstMatchingValue(juce::jmax(0.0, framesPerSecond));
+    }
+
+    consumers.counts[(size_t)kind].fetch_sub(1);
+    updateLeaderJob();
+    updateBackgroundTick();
+}
+void AnalysisEngine::updateBackgroundTick()
+{
+    // the audio thread only flags what it wants. A view on screen applies it from its own frame tick; a pair that's
+    // only captured or published has its leader ticked in the scheduler's background, and an idle one isn't ticked at all
+    auto& leader = stereoLeader != nullptr ? *stereoLeader : *this;
+    auto* partner = leader.stereoPartner;
+    auto onScreen = leader.consumers.anyOnScreen() || (partner != nullptr && partner->consumers.anyOnScreen());
+    auto shouldTick = leader.isActive() && ! onScreen;
+
+    if (shouldTick == leader.backgroundTicking)
+        return;
+
+    leader.backgroundTicking = shouldTick;
+
+    if (shouldTick)
+        leader.frameScheduler->addBackground(leader);
+    else
+        leader.frameScheduler->removeBackground(leader);
+}
+bool AnalysisEngine::isActive() const
+{
+    return consumers.any() || (stereoPartner != nullptr && stereoPartner->consumers.any());
+}
+double AnalysisEngine::getFrameRateDemand() const
+{
+    // -1 for nobody, 0 for every frame, otherwise the fastest consumer's rate
+    const juce::SpinLock::ScopedLockType lock(consumerLock);
+
+    if (consumerRates.isEmpty())
+        return -1.0;
+
+    if (consumerRates.contains(0.0))
+        return 0.0;
+
+    double fastest = 0.0;
+    for (auto rate : consumerRates)
+        fastest = juce::jmax(fastest, rate);
+
+    return fastest;
+}
+void AnalysisEngine::updateLeaderJob()
+{
+    // the job that does the work is the leader's, and it has frames someone can see if either channel is on screen
+    auto& leader = stereoLeader != nullptr ? *stereoLeader : *this;
+    auto* partner = leader.stereoPartner;
+    auto onScreen = leader.consumers.anyOnScreen() || (partner != nullptr && partner->consumers.anyOnScreen());
+
+    leader.fftProcessingJob.setPriority(onScreen ? AnalysisJob::Priority::high : AnalysisJob::Priority::normal);
+
+    // both channels of a pair come out of the same frames, so they're published at the faster demand of the two
+    auto demand = leader.getFrameRateDemand();
+    auto partnerDemand = partner != nullptr ? partner->getFrameRateDemand() : -1.0;
+
+    if (demand < 0.0 || partnerDemand == 0.0)
+        demand = partnerDemand;
+    else if (demand > 0.0)
+        demand = juce::jmax(demand, partnerDemand);
+
+    leader.fftProcessingJob.setConsumedFrameRate(juce::jmax(0.0, demand));
+}
+void AnalysisEngine::setFrequencyScale(SpectrumMapper::Scale scale, SpectrumMapper::Aggregation agg)
+{
+    auto scaleChanged = requestedScale.exchange(scale) != scale;
+    auto aggregationChanged = requestedAggregation.exchange(agg) != agg;
+
+    if (scaleChanged || aggregationChanged)
+        settingsPending.store(true);
+}
+void AnalysisEngine::applyRequestedScale()
+{
+    auto scale = requestedScale.load();
+    auto agg = requestedAggregation.load();
+    if (scale == frequencyScale && agg == aggregation)
+        return;
+
+    frequencyScale = scale;
+    aggregation = agg;
+
+    // a stereo partner's job is idle, and only needs the new tables if it's ever unlinked
+    if (stereoLeader != nullptr)
+    {
+        jobIsStale = true;
+    }
+    else
+    {
+        fftProcessingJob.suspend();
+        fftProcessingJob.prepare(currentSampleRate, currentFFTOrder, currentMultiResolution, frequencyScale, aggregation);
+        fftProcessingJob.resume();
+    }
+
+    // readers label the points from the axis, so it has to follow the scale the levels are mapped on
+    if (sharedSpectrum != nullptr)
+        sharedSpectrum->prepare(currentSampleRate, FFTSizes::numPoints, frequencyScale);
+}
+void AnalysisEngine::setOverlap(float newOverlap)
+{
+    // like setFFTOrder(), called every block, so only a change is flagged
+    newOverlap = juce::jlimit(0.0f, 0.99f, newOverlap);
+    if (requestedOverlap.exchange(newOverlap) != newOverlap)
+        settingsPending.store(true);
+}
+void AnalysisEngine::applyRequestedOverlap()
+{
+    auto requested = requestedOverlap.load();
+    if (requested == overlap)
+        return;
+
+    analysisRate = 0.0;
+    overlap = requested;
+    updateHopSize();
+}
+void AnalysisEngine::setAnalysisRate(double framesPerSecond)
+{
+    jassert(framesPerSecond > 0.0);
+    analysisRate = framesPerSecond;
+    updateHopSize();
+}
+void AnalysisEngine::updateHopSize()
+{
+    if (analysisRate > 0.0)
+        fftProcessingJob.setHopSize(juce::roundToInt(currentSampleRate / analysisRate));
+    else
+        fftProcessingJob.setHopSize(juce::roundToInt((1.0f - overlap) * (float)(1 << currentFFTOrder)));
+}
+void AnalysisEngine::setFFTOrder(int order)
+{
+    // called every block, so all it does is store the request, and flag it for the message thread if it's new
+    order = juce::jlimit(FFTPipeline::minOrder, FFTPipeline::maxOrder, order);
+    if (requestedOrder.exchange(order) != order)
+        settingsPending.store(true);
+}
+void AnalysisEngine::setMultiResolution(bool shouldBeMultiResolution)
+{
+    if (requestedMultiResolution.exchange(shouldBeMultiResolution) != shouldBeMultiResolution)
+        settingsPending.store(true);
+}
+void AnalysisEngine::frameTick()
+{
+    applyPendingSettings();
+}
+void AnalysisEngine::applyPendingSettings()
+{
+    // a pair's views may show either channel, so whichever is ticked brings both up to date
+    auto& leader = stereoLeader != nullptr ? *stereoLeader : *this;
+    leader.applyRequestedSettings();
+
+    if (leader.stereoPartner != nullptr)
+        leader.stereoPartner->applyRequestedSettings();
+}
+void AnalysisEngine::applyRequestedSettings()
+{
+    // one exchange while nothing changes
+    if (! settingsPending.exchange(false))
+        return;
+
+    applyRequestedOverlap();
+    applyRequestedScale();
+    applyRequestedPipeline();
+}
+void AnalysisEngine::applyRequestedPipeline()
+{
+    auto order = requestedOrder.load();
+    auto multiResolution = requestedMultiResolution.load();
+    if (order == currentFFTOrder && multiResolution == currentMultiResolution)
+        return;
+
+    currentFFTOrder = order;
+    currentMultiResolution = multiResolution;
+    updateHopSize();
+
+    // the leader's pipeline analyzes both channels of a pair
+    if (stereoLeader != nullptr)
+        jobIsStale = true;
+    else
+        fftProcessingJob.setPipeline(order, multiResolution);
+}
+void AnalysisEngine::pushSamples(const juce::dsp::AudioBlock<float>& block)
+{
+    // the leader decides once per block for both channels, so a pair's rings always hold the same samples
+    if (stereoLeader == nullptr)
+    {
+        auto active = isActive();
+        if (active && ! pushing)
+            fftProcessingJob.resumeFrom(sampleRing.getWritePosition());
+
+        pushing = active;
+    }
+
+    if (! (stereoLeader != nullptr ? stereoLeader->pushing : pushing))
+        return;
+
+    sampleRing.write(block.getChannelPointer(0), (int)block.getNumSamples());
+
+    // the job matches each frame to the block that completed it; a stereo partner's blocks arrive with its leader's
+    if (latencyMonitor != nullptr && stereoLeader == nullptr)
+        blockStamps.push({ sampleRing.getWritePosition(), LatencyMonitor::now() });
+
+    auto& job = stereoLeader != nullptr ? stereoLeader->fftProcessingJob : fftProcessingJob;
+    if (job.isFrameReady())
+        job.schedule();
+}
+void AnalysisEngine::setStereoPartner(AnalysisEngine* right)
+{
+    fftProcessingJob.suspend();
+
+    // an old partner goes back to analyzing itself, with whatever settings changed while it was paired
+    if (stereoPartner != nullptr && stereoPartner != right)
+    {
+        auto& old = *stereoPartner;
+        old.stereoLeader = nullptr;
+
+        if (old.jobIsStale)
+            old.fftProcessingJob.prepare(old.currentSampleRate, old.currentFFTOrder, old.currentMultiResolution, old.frequencyScale, old.aggregation);
+
+        old.jobIsStale = false;
+        old.updateLeaderJob();
+        old.fftProcessingJob.resume();
+    }
+
+    if (right != nullptr)
+    {
+        right->fftProcessingJob.suspend();
+        right->stereoLeader = this;
+        right->pushing = false;
+        fftProcessingJob.setStereoPartner(&right->channel);
+    }
+    else
+    {
+        fftProcessingJob.setStereoPartner(nullptr);
+    }
+
+    stereoPartner = right;
+    pushing = false;
+    updateLeaderJob();
+
+    fftProcessingJob.resume();
+}
+void AnalysisEngine::setLatencyMonitor(LatencyMonitor* monitor)
+{
+    latencyMonitor = monitor;
+    fftProcessingJob.setLatencyMonitor(monitor);
+}
+//==============================================================================
+void FrameAverager::reset()
+{
+    for (auto& channel : power)
+        channel.fill(0.0f);
+
+    numFrames.fill(0);
+}
+void FrameAverager::add(int channel, const float* values)
+{
+    auto& sum = power[(size_t)channel];
+    for (size_t i = 0; i < sum.size(); ++i)
+        sum[i] += values[i] * values[i];
+
+    ++numFrames[(size_t)channel];
+}
+void FrameAverager::getMean(int channel, float* values) const
+{
+    auto& sum = power[(size_t)channel];
+    auto count = numFrames[(size_t)channel];
+    if (count == 0)
+        return;
+
+    auto toMean = 1.0f / (float)count;
+    for (size_t i = 0; i < sum.size(); ++i)
+        values[i] = std::sqrt(sum[i] * toMean);
+}
+//==============================================================================
+FFTProcessingJob::FFTProcessingJob(const AnalysisChannel& ownChannel, BlockStampFifo& stamps) :
+    channel(ownChannel), sampleRing(ownChannel.ring), blockStamps(stamps)
+{
+}
+FFTProcessingJob::~FFTProcessingJob()
+{
+    suspend();
+    delete pendingPipeline.exchange(nullptr);
+}
+void FFTProcessingJob::prepare(double newSampleRate, int order, bool multiResolution, SpectrumMapper::Scale newScale, SpectrumMapper::Aggregation newAggregation)
+{
+    sampleRate = newSampleRate;
+    scale = newScale;
+    aggregation = newAggregation;
+
+    delete pendingPipeline.exchange(nullptr);
+    pipeline = makePipeline(order, multiResolution);
+    currentFFTSize = pipeline->getSize();
+
+    smoother.prepare(FFTSizes::numPoints);
+    partnerSmoother.prepare(FFTSizes::numPoints);
+    smoothedHopSize = 0;
+    resumePosition = 0;
+    framesPerPublish = 1;
+    startNewGroup();
+}
+void FFTProcessingJob::setBallistics(const SpectrumSmoother::Ballistics& newBallistics)
+{
+    // each field is picked up on its own; a frame set up from a mix of old and new is put right by the next one
+    requestedAttackMs.store(newBallistics.attackMs, std::memory_order_relaxed);
+    requestedReleaseMs.store(newBallistics.releaseMs, std::memory_order_relaxed);
+    requestedPeakHoldMs.store(newBallistics.peakHoldMs, std::memory_order_relaxed);
+    requestedPeakDecay.store(newBallistics.peakDecayDbPerSecond, std::memory_order_relaxed);
+}
+SpectrumSmoother::Ballistics FFTProcessingJob::getRequestedBallistics() const
+{
+    SpectrumSmoother::Ballistics requested;
+    requested.attackMs = requestedAttackMs.load(std::memory_order_relaxed);
+    requested.releaseMs = requestedReleaseMs.load(std::memory_order_relaxed);
+    requested.peakHoldMs = requestedPeakHoldMs.load(std::memory_order_relaxed);
+    requested.peakDecayDbPerSecond = requestedPeakDecay.load(std::memory_order_relaxed);
+    return requested;
+}
+std::unique_ptr<FFTPipeline> FFTProcessingJob::makePipeline(int order, bool multiResolution) const
+{
+    auto newPipeline = createFFTPipeline(order, multiResolution);
+    newPipeline->prepare(sampleRate, FFTSizes::numPoints, scale, aggregation);
+    return newPipeline;
+}
+void FFTProcessingJob::setPipeline(int order, bool multiResolution)
+{
+    // a pipeline the job never picked up can go straight away
+    delete pendingPipeline.exchange(makePipeline(order, multiResolution).release());
+}
+void FFTProcessingJob::swapInPendingPipeline()
+{
+    // the old pipeline is freed here on the worker, never on the audio thread
+    if (auto* next = pendingPipeline.exchange(nullptr))
+    {
+        pipeline.reset(next);
+        currentFFTSize = pipeline->getSize();
+    }
+}
+void FFTProcessingJob::setStereoPartner(const AnalysisChannel* right)
+{
+    partner = right;
+    partnerRing = right != nullptr ? &right->ring : nullptr;
+
+    // sized once for the largest FFT, so changing order never touches frames a reader might hold
+    if (partnerRing != nullptr)
+        stereoSpectra.forEachFrame([](StereoSpectrum& spectrum) { spectrum.allocate((1 << FFTPipeline::maxOrder) / 2 + 1); });
+
+    if (pipeline != nullptr)
+        pipeline->resetStereo();
+}
+bool FFTProcessingJob::isFrameReady() const
+{
+    auto ready = sampleRing.getNumReady();
+    if (partnerRing != nullptr)
+        ready = juce::jmin(ready, partnerRing->getNumReady());
+
+    return ready >= currentFFTSize.load(std::memory_order_relaxed);
+}
+void FFTProcessingJob::skipStaleSamples()
+{
+    // whatever was left over from before the pause would make the first window straddle the gap
+    auto stale = resumePosition.load(std::memory_order_acquire) - sampleRing.getReadPosition();
+    if (stale <= 0)
+        return;
+
+    auto toSkip = (int)juce::jmin(stale, (juce::int64)sampleRing.getNumReady());
+    if (partnerRing != nullptr)
+        toSkip = juce::jmin(toSkip, partnerRing->getNumReady());
+
+    sampleRing.advance(toSkip);
+    if (partnerRing != nullptr)
+        partnerRing->advance(toSkip);
+
+    // and the curve picks up from the new audio rather than falling from wherever it was left
+    smoother.reset();
+    partnerSmoother.reset();
+    startNewGroup();
+}
+int FFTProcessingJob::getFramesPerPublish(int hop) const
+{
+    // publish at least as often as asked, so the slowest consumer still gets a fresh frame every time it looks
+    auto rate = consumedFrameRate.load(std::memory_order_relaxed);
+    if (rate <= 0.0)
+        return 1;
+
+    return juce::jmax(1, (int)(sampleRate / ((double)hop * rate)));
+}
+void FFTProcessingJob::startNewGroup()
+{
+    groupPosition = 0;
+    groupAverage.reset();
+}
+juce::int64 FFTProcessingJob::findAudioTimestamp()
+{
+    // the first block ending at or after the frame's newest sample completed it; anything older can't match a later frame either
+    auto frameEnd = sampleRing.getReadPosition() + pipeline->getSize();
+
+    // each frame looks once, so a frame that finds no stamp at all is what counts as starved
+    blockStamps.noteWakeup();
+    while (auto* stamp = blockStamps.read_slot())
+    {
+        if (stamp->endSample >= frameEnd)
+            return stamp->ticks;
+
+        blockStamps.release();
+    }
+
+    return 0;
+}
+void FFTProcessingJob::runJob()
+{
+    // a few frames per run, so one busy analyzer can't starve the others sharing the pool
+    constexpr int maxFramesPerRun = 4;
+
+    for (int frame = 0; frame < maxFramesPerRun;)
+    {
+        swapInPendingPipeline();
+        skipStaleSamples();
+
+        if (! isFrameReady() || shouldExit())
+        {
+            if (frame == 0)
+                sampleRing.noteStarved();
+
+            return;
+        }
+
+        auto size = pipeline->getSize();
+        auto hop = juce::jmin(hopSize.load(), size);
+        auto perPublish = getFramesPerPublish(hop);
+
+        // the ballistics are specified in time, so follow the rate frames are published at, and any new settings
+        auto requestedBallistics = getRequestedBallistics();
+        if (hop != smoothedHopSize || perPublish != framesPerPublish || requestedBallistics != ballistics)
+        {
+            if (hop != smoothedHopSize || perPublish != framesPerPublish)
+                startNewGroup();
+
+            ballistics = requestedBallistics;
+            smoother.setFrameRate(sampleRate / (hop * perPublish), ballistics);
+            partnerSmoother.setFrameRate(sampleRate / (hop * perPublish), ballistics);
+            smoothedHopSize = hop;
+            framesPerPublish = perPublish;
+        }
+
+        auto endOfGroup = ++groupPosition >= framesPerPublish;
+
+        // nobody would see this hop: step over it without an FFT, which doesn't count towards the frames per run.
+        // The pipeline still sees the samples, so anything it keeps across frames follows the signal
+        if (! endOfGroup && decimation.load(std::memory_order_relaxed) == Decimation::skip)
+        {
+            framesDecimated.fetch_add(1, std::memory_order_relaxed);
+            pipeline->skipFrame(sampleRing, partnerRing);
+            sampleRing.advance(hop);
+            if (partnerRing != nullptr)
+                partnerRing->advance(hop);
+
+            continue;
+        }
+
+        // if we've fallen too far behind, jump to the newest whole hop rather than let the writer drop samples
+        auto ready = sampleRing.getNumReady();
+        if (partnerRing != nullptr)
+            ready = juce::jmin(ready, partnerRing->getNumReady());
+
+        auto backlog = ready - size;
+        if (backlog > juce::jmin(sampleRing.getCapacity() / 2, 4 * size))
+        {
+            framesSkipped.fetch_add(backlog / hop, std::memory_order_relaxed);
+            sampleRing.advance(backlog - backlog % hop);
+            if (partnerRing != nullptr)
+                partnerRing->advance(backlog - backlog % hop);
+        }
+
+        frameTimestamps = {};
+        if (latencyMonitor != nullptr)
+        {
+            frameTimestamps.audio = findAudioTimestamp();
+            frameTimestamps.analysisStart = LatencyMonitor::now();
+            latencyMonitor->record(LatencyMonitor::queued, frameTimestamps.audio, frameTimestamps.analysisStart);
+        }
+
+        if (partner != nullptr)
+        {
+            // the extra spectra cost a pool slot and the cross-spectrum work, so only while someone reads them;
+            // the time average starts over when they do, rather than from whatever was playing last time
+            auto wantsStereo = channel.consumers.wants(AnalysisConsumers::stereo);
+            if (wantsStereo && ! fillingStereoSpectra)
+                pipeline->resetStereo();
+
+            fillingStereoSpectra = wantsStereo;
+
+            auto spectrumHandle = wantsStereo ? stereoSpectra.acquire() : StereoSpectrumPool::invalidHandle;
+            auto* spectrum = spectrumHandle != StereoSpectrumPool::invalidHandle ? &stereoSpectra.get(spectrumHandle) : nullptr;
+
+            pipeline->processStereo(sampleRing, *partnerRing, spectrum);
+
+            if (spectrum != nullptr)
+                stereoSpectra.publish(spectrumHandle);
+
+            publishCurve(0, channel, smoother, endOfGroup);
+            publishCurve(1, *partner, partnerSmoother, endOfGroup);
+        }
+        else
+        {
+            pipeline->processMono(sampleRing);
+            publishCurve(0, channel, smoother, endOfGroup);
+        }
+
+        if (endOfGroup)
+            startNewGroup();
+
+        if (latencyMonitor != nullptr)
+            latencyMonitor->record(LatencyMonitor::analysis, frameTimestamps.analysisStart, LatencyMonitor::now());
+
+        framesAnalysed.fetch_add(1, std::memory_order_relaxed);
+        sampleRing.advance(hop);
+        if (partnerRing != nullptr)
+            partnerRing->advance(hop);
+
+        ++frame;
+    }
+
+    // more is waiting: go to the back of the queue rather than hold on to the worker
+    if (isFrameReady())
+        schedule();
+}
+void FFTProcessingJob::publishCurve(int channelOffset, const AnalysisChannel& destination, SpectrumSmoother& channelSmoother, bool endOfGroup)
+{
+    pipeline->map(channelOffset, curveData.data());                             // [3]
+
+    // frames that won't be published on their own go into the power average of the one that will; a skipped
+    // hop never gets here, so the mean is over the frames actually analyzed, and a lone frame is published as is
+    if (! endOfGroup || groupAverage.getNumFrames(channelOffset) > 0)
+    {
+        groupAverage.add(channelOffset, curveData.data());
+
+        if (! endOfGroup)
+            return;
+
+        groupAverage.getMean(channelOffset, curveData.data());
+    }
+
+    // a channel nobody is taking frames from only keeps its smoothing going, for when someone attaches
+    channelSmoother.process(curveData.data(), (float)pipeline->getSize());      // [4]
+
+    const auto& consumers = destination.consumers;
+
+    if (consumers.wants(AnalysisConsumers::spectrogram))
+    {
+        // while the view holds every column, frames are folded together rather than lost, so a
+        // transient still shows up, in the column that goes out once the view catches up
+        auto& columns = destination.spectrogram;
+        auto& held = heldColumns[(size_t)channelOffset];
+        auto& holding = holdingColumn[(size_t)channelOffset];
+        auto columnHandle = columns.acquire();
+        auto* levels = columnHandle != ColumnPool::invalidHandle ? columns.get(columnHandle).levels.data()
+                                                                 : quantizedLevels.data();
+        channelSmoother.getQuantizedLevels(levels);
+
+        if (holding)
+            for (size_t i = 0; i < held.size(); ++i)
+                levels[i] = juce::jmax(levels[i], held[i]);
+
+        holding = columnHandle == ColumnPool::invalidHandle;
+
+        if (holding)
+            std::copy(levels, levels + held.size(), held.begin());
+        else
+            columns.publish(columnHandle);
+    }
+    else
+    {
+        holdingColumn[(size_t)channelOffset] = false;
+    }
+
+    if (capture != nullptr && consumers.wants(AnalysisConsumers::capture) && capture->isCapturing())
+    {
+        channelSmoother.getQuantizedLevels(quantizedLevels.data());
+        capture->push(channelIndex + channelOffset, pipeline->getSize(), sampleRing.getReadPosition(), quantizedLevels.data());
+    }
+
+    if (sharedSpectrum != nullptr && consumers.wants(AnalysisConsumers::sharedMemory) && sharedSpectrum->isOpen())
+    {
+        // meter the window this frame analyzed; the ring hasn't moved on from it yet
+        auto size = pipeline->getSize();
+        auto span = destination.ring.peek(size);
+        auto peak = 0.0f, sumSquares = 0.0f;
+
+        for (auto part : { std::make_pair(span.first, span.firstSize), std::make_pair(span.second, span.secondSize) })
+        {
+            for (int i = 0; i < part.second; ++i)
+            {
+                peak = juce::jmax(peak, std::abs(part.first[i]));
+                sumSquares += part.first[i] * part.first[i];
+            }
+        }
+
+        sharedSpectrum->publish(channelIndex + channelOffset, size, channelSmoother.getLevels(), channelSmoother.getPeaks(),
+                                peak, std::sqrt(sumSquares / (float)size));
+    }
+
+    if (! consumers.wants(AnalysisConsumers::curve))
+        return;
+
+    //Make path in a pooled path, reusing its storage
+    auto& paths = destination.paths;
+    auto pathHandle = paths.acquire();
+    if (pathHandle == PathPool::invalidHandle)
+        return;
+
+    auto* levels = channelSmoother.getLevels();
+    auto* peaks = channelSmoother.getPeaks();
+
+    // straight into pixels when we know the consumer's size, with as many vertices as the width can show
+    auto width = destination.curveTarget.width.load(std::memory_order_relaxed);
+    auto height = destination.curveTarget.height.load(std::memory_order_relaxed);
+    auto rasterizing = width > 0 && height > 0;
+
+    auto& frame = paths.get(pathHandle);
+    curveRenderer.buildPath(frame.path, levels, peaks, FFTSizes::numPoints, rasterizing ? width : 0, rasterizing ? height : 0);
+
+    if (rasterizing)
+        curveRenderer.rasterize(frame, width, height);
+    else
+        frame.image = {};
+
+    frame.timestamps = frameTimestamps;
+    if (latencyMonitor != nullptr)
+        frame.timestamps.published = LatencyMonitor::now();
+
+    paths.publish(pathHandle);
+}
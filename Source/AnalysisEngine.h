@@ -0,0 +1,399 @@
+/*
+  ==============================================================================
+
+    AnalysisEngine.h
+    One channel's headless analysis: the sample ring the audio thread fills,
+    the job that turns it into spectra, and the queues those spectra leave by.
+    Owned by the processor; components and other outputs attach to it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "Fifo.h"
+#include "SampleRing.h"
+#include "AnalysisWorkerPool.h"
+#include "SpectrumMapper.h"
+#include "SpectrumSmoother.h"
+#include "LatencyMonitor.h"
+#include "FFTPipeline.h"
+#include "SpectrumCapture.h"
+#include "SharedSpectrumPublisher.h"
+#include "CurveRenderer.h"
+#include "FrameScheduler.h"
+//============================================================================
+enum FFTSizes
+{
+    fftOrder = 11,              // the default; FFTPipeline::minOrder to maxOrder can be chosen at runtime
+    fftSize = 1 << fftOrder,
+    numPoints = 512
+};
+//==============================================================================
+using PathPool = FramePool<CurveFrame, 4>;
+/** When each audio block's last sample went into the ring, counted in samples since prepare. */
+struct BlockStamp
+{
+    juce::int64 endSample = 0;
+    juce::int64 ticks = 0;
+};
+using BlockStampFifo = Fifo<BlockStamp, 256>;
+using StereoSpectrumPool = FramePool<StereoSpectrum, 4>;
+/** One frame's smoothed levels, quantized to 0..255, for the spectrogram's history. */
+struct SpectrogramColumn
+{
+    std::array<uint8_t, FFTSizes::numPoints> levels;
+};
+/** Enough for the columns of one GUI tick at FrameScheduler's slowest 15 fps with 96 kHz audio and a
+    128-sample hop (50 of them). Frames that still find every column taken are folded into the next one. */
+using ColumnPool = FramePool<SpectrogramColumn, 64>;
+//==============================================================================
+/** Who is taking a channel's frames, counted per kind of output. Each kind is only produced while someone wants it. */
+struct AnalysisConsumers
+{
+    enum Kind
+    {
+        curve,          // drawn paths
+        spectrogram,    // quantized columns
+        capture,        // frames streamed to a capture file
+        sharedMemory,   // latest frame and meters for other processes
+        stereo,         // mid/side, phase and correlation of a stereo pair; attach to the leader
+        numKinds
+    };
+
+    bool wants(Kind kind) const { return counts[(size_t)kind].load(std::memory_order_relaxed) > 0; }
+    bool any() const
+    {
+        for (auto& count : counts)
+            if (count.load(std::memory_order_relaxed) > 0)
+                return true;
+
+        return false;
+    }
+    bool anyOnScreen() const { return wants(curve) || wants(spectrogram); }
+
+    std::array<std::atomic<int>, numKinds> counts{};
+};
+/** The size in pixels the curve consumer draws at; 0 by 0 means curves are only made as paths. */
+struct CurveTarget
+{
+    std::atomic<int> width{ 0 }, height{ 0 };
+};
+/** Where one channel's frames come from and go to, and who is taking them. */
+struct AnalysisChannel
+{
+    SampleRing& ring;
+    PathPool& paths;
+    ColumnPool& spectrogram;
+    const AnalysisConsumers& consumers;
+    const CurveTarget& curveTarget;
+};
+//==============================================================================
+/** The summed power of the frames in one publish group, per channel, so the frame that is published can be their mean. */
+struct FrameAverager
+{
+    void reset();
+    void add(int channel, const float* values);
+    /** How many frames channel has had added since the last reset(). */
+    int getNumFrames(int channel) const { return numFrames[(size_t)channel]; }
+    /** Overwrites values with the RMS of everything channel has had added. */
+    void getMean(int channel, float* values) const;
+
+private:
+    std::array<std::array<float, FFTSizes::numPoints>, 2> power;
+    std::array<int, 2> numFrames{};
+};
+//==============================================================================
+struct FFTProcessingJob : AnalysisJob
+{
+    FFTProcessingJob(const AnalysisChannel& channel, BlockStampFifo&);
+    ~FFTProcessingJob() override;
+    void runJob() override;
+
+    /** Builds the pipeline for order and resets the smoothing. Only call while the job is suspended. */
+    void prepare(double sampleRate, int order, bool multiResolution, SpectrumMapper::Scale scale, SpectrumMapper::Aggregation aggregation);
+
+    /** Any thread: new ballistics take over from the next frame, carrying on from the current curve. */
+    void setBallistics(const SpectrumSmoother::Ballistics& newBallistics);
+
+    /** Message thread: builds the pipeline for a new order or resolution mode and hands it over without
+        stopping the job, which swaps it in between two frames. The smoothed curve carries on across the switch. */
+    void setPipeline(int order, bool multiResolution);
+    /** The size of the pipeline currently analyzing. */
+    int getFFTSize() const { return currentFFTSize.load(std::memory_order_relaxed); }
+
+    /** Called by the audio thread once a window's worth of new samples is in the ring. */
+    void schedule() { pool->submit(*this, priority); }
+    void setPriority(Priority p) { priority = p; }
+
+    /** How frames beyond what the consumers take are dealt with. */
+    enum class Decimation
+    {
+        skip,       // the window steps over them without an FFT
+        average     // they're analyzed, and their power averaged into the frame that's published
+    };
+
+    /** Frames per second the consumers actually take, or 0 for every frame. Any thread. */
+    void setConsumedFrameRate(double framesPerSecond) { consumedFrameRate.store(framesPerSecond, std::memory_order_relaxed); }
+    void setDecimation(Decimation mode) { decimation.store(mode, std::memory_order_relaxed); }
+
+    /** Audio thread: the rings were left alone while nobody consumed them, and writing starts again at
+        position. The job skips whatever older samples are still waiting, so the first frame is all new audio. */
+    void resumeFrom(juce::int64 position) { resumePosition.store(position, std::memory_order_release); }
+
+    /** Samples the analysis window slides by between frames; the FFT size or more means no overlap. */
+    void setHopSize(int samples) { hopSize = juce::jmax(1, samples); }
+    int getHopSize() const { return hopSize; }
+
+    /** Pairs this (left) channel with a right channel, so each frame analyzes both from the same
+        window. Pass nullptr to go back to mono. Only call while the job is suspended. */
+    void setStereoPartner(const AnalysisChannel* right);
+    bool isFrameReady() const;
+
+    /** Mid/side, phase and correlation for each stereo frame, filled while a stereo consumer is attached. */
+    StereoSpectrumPool& getStereoSpectra() { return stereoSpectra; }
+
+    /** Frames analyzed, and hops jumped over to catch up after falling behind, since construction. */
+    int64_t getNumFramesAnalysed() const { return framesAnalysed.load(std::memory_order_relaxed); }
+    int64_t getNumFramesSkipped() const { return framesSkipped.load(std::memory_order_relaxed); }
+    /** Hops stepped over without an FFT because nobody would have seen them. */
+    int64_t getNumFramesDecimated() const { return framesDecimated.load(std::memory_order_relaxed); }
+
+    /** Nothing is pushed or dropped while no stereo consumer is attached, so a drop here is a reader falling behind. */
+    QueueStats getStereoSpectraStats() const { return stereoSpectra.getStats(); }
+    QueueStats getPoolStats() const { return pool->getStats(); }
+
+    /** Where the queue and analysis latencies go; nullptr turns them off. Set before processing starts. */
+    void setLatencyMonitor(LatencyMonitor* monitor) { latencyMonitor = monitor; }
+    /** Which of the instance's channels this job's own frames are; a stereo partner's are channel + 1. */
+    void setChannel(int channel) { channelIndex = channel; }
+    /** Where frames go while capture is running. Set before processing starts. */
+    void setCapture(SpectrumCapture* newCapture) { capture = newCapture; }
+    /** Where the latest frame and meters are published for other processes. Set before processing starts. */
+    void setSharedSpectrum(SharedSpectrumPublisher* publisher) { sharedSpectrum = publisher; }
+
+private:
+    juce::SharedResourcePointer<AnalysisWorkerPool> pool;
+    std::atomic<Priority> priority{ Priority::normal };
+
+    AnalysisChannel channel;
+    SampleRing& sampleRing;
+    BlockStampFifo& blockStamps;
+    LatencyMonitor* latencyMonitor = nullptr;
+    SpectrumCapture* capture = nullptr;
+    SharedSpectrumPublisher* sharedSpectrum = nullptr;
+    int channelIndex = 0;
+    FrameTimestamps frameTimestamps;
+    std::atomic<int> hopSize{ FFTSizes::fftSize / 2 };
+    std::atomic<juce::int64> resumePosition{ 0 };
+    std::atomic<double> consumedFrameRate{ 0.0 };
+    std::atomic<Decimation> decimation{ Decimation::skip };
+
+    // only runJob() touches the current pipeline, except while suspended; a new one arrives through pendingPipeline
+    std::unique_ptr<FFTPipeline> pipeline;
+    std::atomic<FFTPipeline*> pendingPipeline{ nullptr };
+    std::atomic<int> currentFFTSize{ FFTSizes::fftSize };
+
+    std::array<float, FFTSizes::numPoints> curveData;
+    std::array<uint8_t, FFTSizes::numPoints> quantizedLevels;
+    // per channel: levels of frames that found no free column, max-merged until one frees up
+    std::array<std::array<uint8_t, FFTSizes::numPoints>, 2> heldColumns;
+    std::array<bool, 2> holdingColumn{};
+    CurveRenderer curveRenderer;
+    SpectrumSmoother smoother, partnerSmoother;
+    SpectrumSmoother::Ballistics ballistics;   // the ones the smoothers were last set up with
+    std::atomic<float> requestedAttackMs{ SpectrumSmoother::Ballistics{}.attackMs };
+    std::atomic<float> requestedReleaseMs{ SpectrumSmoother::Ballistics{}.releaseMs };
+    std::atomic<float> requestedPeakHoldMs{ SpectrumSmoother::Ballistics{}.peakHoldMs };
+    std::atomic<float> requestedPeakDecay{ SpectrumSmoother::Ballistics{}.peakDecayDbPerSecond };
+    SpectrumMapper::Scale scale = SpectrumMapper::Scale::logarithmic;
+    SpectrumMapper::Aggregation aggregation = SpectrumMapper::Aggregation::max;
+    double sampleRate = 44100.0;
+    int smoothedHopSize = 0;
+
+    // hops per published frame, how far into the current group of them we are, and the ones analyzed so far
+    int framesPerPublish = 1;
+    int groupPosition = 0;
+    FrameAverager groupAverage;
+
+    const AnalysisChannel* partner = nullptr;
+    SampleRing* partnerRing = nullptr;
+    StereoSpectrumPool stereoSpectra;
+    bool fillingStereoSpectra = false;
+
+    std::atomic<int64_t> framesAnalysed{ 0 }, framesSkipped{ 0 }, framesDecimated{ 0 };
+
+    std::unique_ptr<FFTPipeline> makePipeline(int order, bool multiResolution) const;
+    void swapInPendingPipeline();
+    SpectrumSmoother::Ballistics getRequestedBallistics() const;
+    void skipStaleSamples();
+    int getFramesPerPublish(int hop) const;
+    void startNewGroup();
+    juce::int64 findAudioTimestamp();
+    void publishCurve(int channelOffset, const AnalysisChannel& destination, SpectrumSmoother& channelSmoother, bool endOfGroup);
+};
+//==============================================================================
+/**
+    The analysis for one channel, with no GUI of its own.
+
+    Nothing runs unless something is attached: while no consumer of any kind
+    is registered on this engine (or on its stereo partner), pushSamples()
+    returns without touching the ring and no job is ever scheduled, so an
+    instance whose editor is closed costs nothing beyond its processBlock, not
+    even a message-thread wakeup. Attaching takes effect from the next audio block.
+
+    Each consumer says how many frames per second it takes. While every
+    consumer has a rate, the job only publishes about as many frames as the
+    fastest of them takes, and either skips the FFTs in between or averages
+    them in (see setDecimation()). A consumer with no rate, like a capture,
+    gets every frame.
+*/
+struct AnalysisEngine : private FrameScheduler::Client
+{
+    AnalysisEngine();
+    ~AnalysisEngine() override;
+
+    void prepare(double sampleRate, int samplesPerBlock);
+    /** Audio thread. A stereo partner's samples must be pushed after its leader's, for the same block. */
+    void pushSamples(const juce::dsp::AudioBlock<float>& block);
+
+    /** Message thread. framesPerSecond is how often this consumer takes a frame, or 0 for every frame.
+        Each attach() needs a matching detach() with the same rate. Attaching applies any settings
+        changed while the engine was idle. */
+    void attach(AnalysisConsumers::Kind kind, double framesPerSecond = 0.0);
+    void detach(AnalysisConsumers::Kind kind, double framesPerSecond = 0.0);
+    /** True while this engine or its stereo partner has any consumer. */
+    bool isActive() const;
+    /** Message thread: applies the order, overlap and scale last asked for, if any of them changed, to
+        this engine and its stereo pair. Views call it from their frame ticks; a pair with consumers but
+        none on screen gets a FrameScheduler background tick that calls it, and an idle one nothing. */
+    void applyPendingSettings();
+
+    /** Fraction of each window shared with the next one, e.g. 0.5, 0.75 or 0.875. Safe from any thread,
+        like setFFTOrder(); the message thread applies the new hop. Overrides setAnalysisRate(). */
+    void setOverlap(float overlap);
+    /** Message thread: spectra per second, independent of the sample rate and FFT size, until the
+        overlap next changes. Rates below sampleRate / fftSize are limited to one frame per window. */
+    void setAnalysisRate(double framesPerSecond);
+
+    /** FFTPipeline::minOrder to maxOrder. Safe from any thread, including the audio thread, where it's
+        an atomic exchange that flags only a change; the message thread then builds the new pipeline and
+        the job swaps it in between frames. */
+    void setFFTOrder(int order);
+    int getFFTOrder() const { return currentFFTOrder; }
+    /** Adds longer FFTs of a decimated signal for the low end, stitched into the same curve. Safe from any thread. */
+    void setMultiResolution(bool shouldBeMultiResolution);
+    bool isMultiResolution() const { return currentMultiResolution; }
+
+    /** What happens to the frames nobody takes. A stereo partner's frames follow its leader's setting. */
+    void setDecimation(FFTProcessingJob::Decimation mode) { fftProcessingJob.setDecimation(mode); }
+
+    /** Frequency axis and how bins sharing a display point are combined. A stereo partner is drawn
+        with its leader's settings. Safe from any thread, like setFFTOrder(); the message thread rebuilds
+        the tables, and moves the shared-memory axis over to the new scale. */
+    void setFrequencyScale(SpectrumMapper::Scale scale, SpectrumMapper::Aggregation aggregation);
+    SpectrumMapper::Scale getFrequencyScale() const { return frequencyScale; }
+    /** Attack/release smoothing and peak hold of the drawn curve. Safe from any thread, including the
+        audio thread; the job picks them up before its next frame. A stereo partner follows its leader's. */
+    void setBallistics(const SpectrumSmoother::Ballistics& ballistics) { fftProcessingJob.setBallistics(ballistics); }
+
+    /** Lets this engine's job analyze the right channel too, from the same windows as the left.
+        Call from prepareToPlay, after both engines are prepared; nullptr unlinks. Destroying
+        either engine of a pair unlinks it first. */
+    void setStereoPartner(AnalysisEngine* right);
+    /** Filled while a stereo consumer is attached to this (leader) engine; each frame taken must be recycled. */
+    StereoSpectrumPool& getStereoSpectra() { return fftProcessingJob.getStereoSpectra(); }
+
+    /** For a stereo pair the leader counts the frames of both channels. */
+    int64_t getNumFramesAnalysed() const { return fftProcessingJob.getNumFramesAnalysed(); }
+    int64_t getNumFramesSkipped() const { return fftProcessingJob.getNumFramesSkipped(); }
+    int64_t getNumFramesDecimated() const { return fftProcessingJob.getNumFramesDecimated(); }
+    /** Samples the audio thread couldn't fit in the ring because analysis had fallen that far behind. */
+    int64_t getNumSamplesDropped() const { return (int64_t)sampleRing.getStats().dropped; }
+
+    /** Audio thread -> analysis, in samples. */
+    QueueStats getSampleStats() const { return sampleRing.getStats(); }
+    /** Analysis -> message thread, in curves. */
+    QueueStats getCurveStats() const { return pathPool.getStats(); }
+    QueueStats getBlockStampStats() const { return blockStamps.getStats(); }
+    const FFTProcessingJob& getJob() const { return fftProcessingJob; }
+
+    /** This channel's curves, filled while a curve consumer is attached. */
+    PathPool& getCurves() { return pathPool; }
+    /** Message thread: the size the curve consumer draws at. The analysis then strokes each curve into an
+        image of that size, so drawing it is a single blit; 0 by 0 goes back to paths only. Views narrower
+        than FFTSizes::numPoints get a min/max pair per pixel column, wider ones a smoothed spline. */
+    void setCurveSize(int width, int height)
+    {
+        curveTarget.width = juce::jmax(0, width);
+        curveTarget.height = juce::jmax(0, height);
+    }
+    /** This channel's frames as quantized columns, filled while a spectrogram consumer is attached. */
+    ColumnPool& getSpectrogramColumns() { return spectrogramColumns; }
+
+    /** Stamps frames through every stage into monitor; a stereo partner should share its leader's. */
+    void setLatencyMonitor(LatencyMonitor* monitor);
+    LatencyMonitor* getLatencyMonitor() const { return latencyMonitor; }
+    /** Where this engine's frames go besides the screen, recorded or published as channel. Set before processing starts.
+        Frames only go there while a capture or sharedMemory consumer is attached. */
+    void setOutputs(int channel, SpectrumCapture* capture, SharedSpectrumPublisher* publisher)
+    {
+        sharedSpectrum = publisher;
+        fftProcessingJob.setChannel(channel);
+        fftProcessingJob.setCapture(capture);
+        fftProcessingJob.setSharedSpectrum(publisher);
+    }
+
+private:
+    double currentSampleRate = 44100.0;
+    SpectrumMapper::Scale frequencyScale = SpectrumMapper::Scale::logarithmic;
+    SpectrumMapper::Aggregation aggregation = SpectrumMapper::Aggregation::max;
+    std::atomic<SpectrumMapper::Scale> requestedScale{ SpectrumMapper::Scale::logarithmic };
+    std::atomic<SpectrumMapper::Aggregation> requestedAggregation{ SpectrumMapper::Aggregation::max };
+    SharedSpectrumPublisher* sharedSpectrum = nullptr;
+    AnalysisEngine* stereoLeader = nullptr;
+    AnalysisEngine* stereoPartner = nullptr;
+    double analysisRate = 0.0;
+    float overlap = 0.5f;
+    std::atomic<float> requestedOverlap{ 0.5f };
+    int currentFFTOrder = FFTSizes::fftOrder;
+    std::atomic<int> requestedOrder{ FFTSizes::fftOrder };
+    bool currentMultiResolution = false;
+    std::atomic<bool> requestedMultiResolution{ false };
+    // set by the setters when a request differs from the last one, so the message thread only does work for a change
+    std::atomic<bool> settingsPending{ false };
+    juce::SharedResourcePointer<FrameScheduler> frameScheduler;
+    bool backgroundTicking = false;
+    // a stereo partner's own job sits idle, so settings changes only reach it if it's unlinked
+    bool jobIsStale = false;
+
+    // audio thread only: whether the current block is going into the rings; a partner follows its leader's
+    bool pushing = false;
+
+    void frameTick() override;
+    void updateBackgroundTick();
+    void applyRequestedSettings();
+    void unlinkStereo();
+    void applyRequestedPipeline();
+    void applyRequestedOverlap();
+    void applyRequestedScale();
+    void updateHopSize();
+    void updateLeaderJob();
+    double getFrameRateDemand() const;
+
+    AnalysisConsumers consumers;
+    juce::Array<double> consumerRates;   // one per attached consumer
+    juce::SpinLock consumerLock;
+    SampleRing sampleRing;
+    PathPool pathPool;
+    BlockStampFifo blockStamps;
+    ColumnPool spectrogramColumns;
+    LatencyMonitor* latencyMonitor = nullptr;
+    CurveTarget curveTarget;
+    AnalysisChannel channel{ sampleRing, pathPool, spectrogramColumns, consumers, curveTarget };
+    FFTProcessingJob fftProcessingJob{ channel, blockStamps };
+
+    JUCE_DECLARE_NON_COPYABLE(AnalysisEngine)
+};
@@ -0,0 +1,221 @@
+/*
+  ==============================================================================
+
+    AnalysisWorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "AnalysisWorkerPool.h"
+
+//==============================================================================
+AnalysisJob::~AnalysisJob()
+{
+    // derived jobs must call suspend() in their own destructor, before the state runJob() uses is torn down
+    jassert(state.load() == idle);
+}
+
+void AnalysisJob::suspend()
+{
+    suspended = true;
+
+    while (state.load() != idle)
+        juce::Thread::sleep(1);
+}
+
+//==============================================================================
+AnalysisWorkerPool::AnalysisWorkerPool()
+{
+    // one worker per core, leaving a core free for the host's audio thread
+    auto numWorkers = juce::jmax(1, juce::SystemStats::getNumCpus() - 1);
+    saturationLimit = 4 * numWorkers;
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.add(new Worker(*this, i));
+
+    for (auto* worker : workers)
+        worker->startThread();
+}
+
+AnalysisWorkerPool::~AnalysisWorkerPool()
+{
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (auto* worker : workers)
+    {
+        worker->notify();
+        worker->stopThread(1000);
+    }
+}
+
+bool AnalysisWorkerPool::submit(AnalysisJob& job, AnalysisJob::Priority priority)
+{
+    if (job.suspended)
+        return false;
+
+    job.lastPriority = priority;
+    auto state = job.state.load();
+
+    for (;;)
+    {
+        if (state == AnalysisJob::idle)
+        {
+            if (job.state.compare_exchange_weak(state, AnalysisJob::queued))
+            {
+                if (enqueue(job, priority))
+                    return true;
+
+                job.state = AnalysisJob::idle;
+                return false;
+            }
+        }
+        else if (state == AnalysisJob::running)
+        {
+            if (job.state.compare_exchange_weak(state, AnalysisJob::runningAndRequeued))
+                return true;
+        }
+        else
+        {
+            // already waiting for a worker
+            return true;
+        }
+    }
+}
+
+bool AnalysisWorkerPool::enqueue(AnalysisJob& job, AnalysisJob::Priority priority)
+{
+    // back-pressure: when the pool is saturated only high priority work gets in
+    if (priority == AnalysisJob::Priority::normal && numQueued.load() >= saturationLimit)
+    {
+        numDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto queued = (uint64_t)++numQueued;
+    auto peak = peakQueued.load(std::memory_order_relaxed);
+    while (queued > peak && ! peakQueued.compare_exchange_weak(peak, queued, std::memory_order_relaxed)) {}
+
+    auto numWorkers = workers.size();
+    auto first = (int)(nextWorker.fetch_add(1) % (unsigned int)numWorkers);
+    auto queueIndex = (size_t)priority;
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto workerIndex = (first + i) % numWorkers;
+
+        if (workers.getUnchecked(workerIndex)->queues[queueIndex].push(&job))
+        {
+            numPushed.fetch_add(1, std::memory_order_relaxed);
+            wakeWorker(workerIndex);
+            return true;
+        }
+    }
+
+    --numQueued;
+    numDropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+QueueStats AnalysisWorkerPool::getStats() const
+{
+    QueueStats stats;
+    stats.pushed = numPushed.load(std::memory_order_relaxed);
+    stats.dropped = numDropped.load(std::memory_order_relaxed);
+    stats.peakOccupancy = peakQueued.load(std::memory_order_relaxed);
+    stats.starved = numStarved.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AnalysisWorkerPool::wakeWorker(int firstCandidate)
+{
+    auto numWorkers = workers.size();
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto* worker = workers.getUnchecked((firstCandidate + i) % numWorkers);
+
+        if (worker->sleeping.exchange(false))
+        {
+            worker->notify();
+            return;
+        }
+    }
+}
+
+AnalysisJob* AnalysisWorkerPool::findJob(int workerIndex)
+{
+    auto numWorkers = workers.size();
+    AnalysisJob* job = nullptr;
+
+    // own queue first, then steal, high priority before normal
+    for (auto queueIndex : { (size_t)AnalysisJob::Priority::high, (size_t)AnalysisJob::Priority::normal })
+    {
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            if (workers.getUnchecked((workerIndex + i) % numWorkers)->queues[queueIndex].pop(job))
+            {
+                --numQueued;
+                return job;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+void AnalysisWorkerPool::runJob(AnalysisJob& job)
+{
+    job.state = AnalysisJob::running;
+
+    if (! job.suspended)
+        job.runJob();
+
+    auto expected = (int)AnalysisJob::running;
+    if (job.state.compare_exchange_strong(expected, AnalysisJob::idle))
+        return;
+
+    // it was submitted again while it ran
+    if (job.suspended)
+    {
+        job.state = AnalysisJob::idle;
+        return;
+    }
+
+    job.state = AnalysisJob::queued;
+
+    if (! enqueue(job, job.lastPriority))
+        job.state = AnalysisJob::idle;
+}
+
+//==============================================================================
+AnalysisWorkerPool::Worker::Worker(AnalysisWorkerPool& p, int i) :
+    Thread("AnalysisWorker " + juce::String(i)), pool(p), index(i)
+{
+}
+
+void AnalysisWorkerPool::Worker::run()
+{
+    while (! threadShouldExit())
+    {
+        if (auto* job = pool.findJob(index))
+        {
+            pool.runJob(*job);
+            continue;
+        }
+
+        sleeping = true;
+
+        // look once more so a submission racing with us going to sleep isn't missed
+        if (auto* job = pool.findJob(index))
+        {
+            sleeping = false;
+            pool.runJob(*job);
+            continue;
+        }
+
+        pool.numStarved.fetch_add(1, std::memory_order_relaxed);
+        wait(100);
+        sleeping = false;
+    }
+}
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    AnalysisWorkerPool.h
+    One set of analysis threads shared by every analyzer in the process.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Fifo.h"
+
+struct AnalysisWorkerPool;
+
+//==============================================================================
+/**
+    A unit of analysis work that can be scheduled on the shared pool.
+
+    A job is never queued twice and never runs on two workers at once:
+    scheduling it while it's queued is a no-op, and scheduling it while it's
+    running marks it to be requeued as soon as the current run returns.
+*/
+struct AnalysisJob
+{
+    enum class Priority
+    {
+        normal,
+        high
+    };
+
+    virtual ~AnalysisJob();
+
+    /** Called on a pool worker. Should do a bounded amount of work and return. */
+    virtual void runJob() = 0;
+
+    /** Blocks until the job is neither queued nor running and stops it being scheduled again. */
+    void suspend();
+    /** Allows the job to be scheduled again after suspend(). */
+    void resume() { suspended = false; }
+
+    bool shouldExit() const { return suspended; }
+
+private:
+    friend struct AnalysisWorkerPool;
+
+    enum State
+    {
+        idle,
+        queued,
+        running,
+        runningAndRequeued
+    };
+
+    std::atomic<int> state{ idle };
+    std::atomic<bool> suspended{ false };
+    std::atomic<Priority> lastPriority{ Priority::normal };
+};
+
+//==============================================================================
+/**
+    Process-wide work-stealing pool, shared through juce::SharedResourcePointer
+    so the thread count stays fixed however many plugin instances are loaded.
+
+    Each worker owns a high and a normal priority queue. Submissions are spread
+    round-robin across workers, and an idle worker steals from the others before
+    going to sleep, always draining high priority work first. When the queues
+    are saturated, normal priority submissions are refused so the caller can
+    coalesce its work into a later submission instead of piling up latency.
+*/
+struct AnalysisWorkerPool
+{
+    AnalysisWorkerPool();
+    ~AnalysisWorkerPool();
+
+    /** Safe to call from any thread, including the audio thread. Returns false if the job was refused. */
+    bool submit(AnalysisJob& job, AnalysisJob::Priority priority);
+
+    int getNumWorkers() const { return workers.size(); }
+    int getNumQueued() const { return numQueued.load(); }
+
+    /** Counted in jobs across every instance in the process. Refused submissions count as dropped;
+        starved counts the times a worker found nothing to do and went to sleep. */
+    QueueStats getStats() const;
+
+private:
+    static constexpr size_t QueueCapacity = 256;
+    using JobQueue = MpmcQueue<AnalysisJob*, QueueCapacity>;
+
+    struct Worker : juce::Thread
+    {
+        Worker(AnalysisWorkerPool& p, int i);
+        void run() override;
+
+        AnalysisWorkerPool& pool;
+        const int index;
+        std::array<JobQueue, 2> queues;
+        std::atomic<bool> sleeping{ false };
+    };
+
+    juce::OwnedArray<Worker> workers;
+
+    std::atomic<int> numQueued{ 0 };
+    std::atomic<unsigned int> nextWorker{ 0 };
+    int saturationLimit = 0;
+
+    std::atomic<uint64_t> numPushed{ 0 }, numDropped{ 0 }, peakQueued{ 0 }, numStarved{ 0 };
+
+    bool enqueue(AnalysisJob& job, AnalysisJob::Priority priority);
+    void wakeWorker(int firstCandidate);
+    AnalysisJob* findJob(int workerIndex);
+    void runJob(AnalysisJob& job);
+
+    JUCE_DECLARE_NON_COPYABLE(AnalysisWorkerPool)
+};
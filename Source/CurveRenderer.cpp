@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    CurveRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "CurveRenderer.h"
+
+//==============================================================================
+namespace
+{
+    float levelToY(float level, float height) { return juce::jmap(level, 0.f, 1.f, height, 0.f); }
+
+    /** One vertex, or a min/max pair in the order they occur, per pixel column, so a view narrower
+        than the data never strokes more than two vertices a pixel. A peak-hold trace only needs the max. */
+    void appendColumns(juce::Path& path, const float* values, int numValues, int width, float height, bool withMinimum)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            auto first = x * numValues / width;
+            auto end = juce::jmax(first + 1, (x + 1) * numValues / width);
+            auto lowest = first, highest = first;
+
+            for (int i = first + 1; i < end; ++i)
+            {
+                if (values[i] < values[lowest])
+                    lowest = i;
+                if (values[i] > values[highest])
+                    highest = i;
+            }
+
+            auto px = (float)x + 0.5f;
+            auto from = withMinimum ? juce::jmin(lowest, highest) : highest;
+            auto to = withMinimum ? juce::jmax(lowest, highest) : highest;
+
+            if (x == 0)
+                path.startNewSubPath(px, levelToY(values[from], height));
+            else
+                path.lineTo(px, levelToY(values[from], height));
+
+            if (to != from)
+                path.lineTo(px, levelToY(values[to], height));
+        }
+    }
+
+    /** A Catmull-Rom spline through the values, for views wider than the data. Each segment is cut
+        into just enough chords to stay within tolerance of the curve, so flat stretches stay one line. */
+    void appendSmooth(juce::Path& path, const float* values, int numValues, int width, float height)
+    {
+        constexpr float tolerance = 0.25f;     // pixels a chord may stray from the curve
+        constexpr int maxSubdivisions = 8;
+
+        auto xScale = (float)width / float(numValues - 1);
+        auto point = [&](int i)
+        {
+            i = juce::jlimit(0, numValues - 1, i);
+            return juce::Point<float>((float)i * xScale, levelToY(values[i], height));
+        };
+
+        path.startNewSubPath(point(0));
+
+        for (int i = 0; i < numValues - 1; ++i)
+        {
+            auto p0 = point(i - 1), p1 = point(i), p2 = point(i + 1), p3 = point(i + 2);
+
+            // the same segment as a cubic Bezier; how far its control points sit off the chord bounds how far the curve does
+            auto c1 = p1 + (p2 - p0) / 6.0f;
+            auto c2 = p2 - (p3 - p1) / 6.0f;
+            auto chord = p2 - p1;
+            auto flatness = juce::jmax(c1.getDistanceFrom(p1 + chord / 3.0f), c2.getDistanceFrom(p1 + chord * (2.0f / 3.0f)));
+            auto steps = juce::jlimit(1, maxSubdivisions, (int)std::ceil(std::sqrt(flatness / tolerance)));
+
+            for (int step = 1; step < steps; ++step)
+            {
+                auto t = (float)step / (float)steps;
+                auto mt = 1.0f - t;
+                auto p = p1 * (mt * mt * mt) + c1 * (3.0f * mt * mt * t) + c2 * (3.0f * mt * t * t) + p2 * (t * t * t);
+
+                // the spline can overshoot past silence or full scale
+                path.lineTo(p.x, juce::jlimit(0.0f, height, p.y));
+            }
+
+            path.lineTo(p2);
+        }
+    }
+}
+
+//==============================================================================
+CurveRenderer::CurveRenderer()
+{
+    auto colours = { juce::Colours::violet, juce::Colours::blue, juce::Colours::green, juce::Colours::yellow,
+                     juce::Colours::orange, juce::Colours::red, juce::Colours::white };
+
+    int i = 0;
+    for (auto colour : colours)
+        gradient.addColour(double(i++) / double(colours.size() - 1), colour);
+}
+void CurveRenderer::buildPath(juce::Path& path, const float* levels, const float* peaks, int numPoints, int width, int height) const
+{
+    path.clear();
+
+    if (width <= 0 || height <= 0)
+    {
+        path.startNewSubPath(0, juce::jmap(levels[0], 0.f, 1.f, 1.f, 0.f));
+
+        for (int i = 1; i < numPoints; ++i)
+        {
+            path.lineTo(float(i), juce::jmap(levels[i], 0.f, 1.f, 1.f, 0.f));
+        }
+
+        // peak hold trace
+        path.startNewSubPath(0, juce::jmap(peaks[0], 0.f, 1.f, 1.f, 0.f));
+
+        for (int i = 1; i < numPoints; ++i)
+        {
+            path.lineTo(float(i), juce::jmap(peaks[i], 0.f, 1.f, 1.f, 0.f));
+        }
+    }
+    else if (width <= numPoints)
+    {
+        appendColumns(path, levels, numPoints, width, (float)height, true);
+        appendColumns(path, peaks, numPoints, width, (float)height, false);
+    }
+    else
+    {
+        appendSmooth(path, levels, numPoints, width, (float)height);
+        appendSmooth(path, peaks, numPoints, width, (float)height);
+    }
+}
+void CurveRenderer::rasterize(CurveFrame& frame, int width, int height)
+{
+    // each pooled frame keeps its image, so this only allocates when the consumer changes size
+    if (frame.image.getWidth() != width || frame.image.getHeight() != height)
+        frame.image = juce::Image(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+    else
+        frame.image.clear(frame.image.getBounds());
+
+    gradient.point1 = { 0, (float)height };
+    gradient.point2 = { 0, 0 };
+
+    juce::Graphics g(frame.image);
+    g.setGradientFill(gradient);
+    g.strokePath(frame.path, juce::PathStrokeType(1));
+}
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    CurveRenderer.h
+    Turns a frame's smoothed levels and peaks into the curve that gets drawn,
+    with only as many vertices as the width can show.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LatencyMonitor.h"
+
+//==============================================================================
+/** One curve, already drawn into an image at the consumer's size, and when it passed each stage on its way to the screen. */
+struct CurveFrame
+{
+    juce::Path path;        // in pixels, only as detailed as the width can show, when there's a target size; otherwise x in points and y from 0 (top) to 1
+    juce::Image image;      // the stroked curve, or invalid while there's no target size
+    FrameTimestamps timestamps;
+};
+
+//==============================================================================
+/**
+    The level trace and the peak-hold trace as one path, stroked with the
+    analyzer's gradient.
+
+    With no size the path is one vertex per point, x in points and y from 0
+    (top) to 1. Views narrower than the data get a min/max pair per pixel
+    column, wider ones a Catmull-Rom spline cut into just enough chords.
+
+    Keeps its gradient between frames, so one instance per thread.
+*/
+struct CurveRenderer
+{
+    CurveRenderer();
+
+    /** Replaces path with the two traces; width or height of 0 gives the unscaled path. */
+    void buildPath(juce::Path& path, const float* levels, const float* peaks, int numPoints, int width, int height) const;
+    /** Strokes frame.path into frame.image, which is only reallocated when the size changes. */
+    void rasterize(CurveFrame& frame, int width, int height);
+
+private:
+    juce::ColourGradient gradient;   // built once; only its end points follow the height
+};
@@ -0,0 +1,313 @@
+/*
+  ==============================================================================
+
+    FFTBackend.cpp
+
+  ==============================================================================
+*/
+
+#include "FFTBackend.h"
+#include <array>
+#include <cmath>
+#include <mutex>
+
+//==============================================================================
+JuceFFTBackend::JuceFFTBackend(int o) :
+    order(o), fft(o), scratch((size_t)(2 << o))
+{
+}
+
+void JuceFFTBackend::performRealMagnitudes(float* data)
+{
+    auto size = getSize();
+
+    juce::FloatVectorOperations::copy(scratch.data(), data, size);
+    juce::FloatVectorOperations::clear(scratch.data() + size, size);
+    fft.performFrequencyOnlyForwardTransform(scratch.data());
+    juce::FloatVectorOperations::copy(data, scratch.data(), size / 2 + 1);
+}
+
+void JuceFFTBackend::performRealForward(float* data)
+{
+    auto size = getSize();
+
+    juce::FloatVectorOperations::copy(scratch.data(), data, size);
+    juce::FloatVectorOperations::clear(scratch.data() + size, size);
+    fft.performRealOnlyForwardTransform(scratch.data(), true);
+    juce::FloatVectorOperations::copy(data, scratch.data(), size + 2);
+}
+
+//==============================================================================
+PortableRealFFT::PortableRealFFT(int o) :
+    order(o), halfSize(1 << (o - 1)), reversed((size_t)halfSize), re((size_t)halfSize), im((size_t)halfSize)
+{
+    jassert(order >= 2);
+
+    for (int i = 0, j = 0; i < halfSize; ++i)
+    {
+        reversed[(size_t)i] = j;
+
+        auto bit = halfSize >> 1;
+        for (; (j & bit) != 0; bit >>= 1)
+            j ^= bit;
+        j |= bit;
+    }
+
+    for (int length = 2; length <= halfSize; length <<= 1)
+    {
+        for (int j = 0; j < length / 2; ++j)
+        {
+            auto angle = -2.0 * juce::MathConstants<double>::pi * (double)j / (double)length;
+            stageRe.push_back((float)std::cos(angle));
+            stageIm.push_back((float)std::sin(angle));
+        }
+    }
+
+    for (int k = 0; k <= halfSize / 2; ++k)
+    {
+        auto angle = -juce::MathConstants<double>::pi * (double)k / (double)halfSize;
+        splitRe.push_back((float)std::cos(angle));
+        splitIm.push_back((float)std::sin(angle));
+    }
+}
+
+void PortableRealFFT::performComplex()
+{
+    auto* zr = re.data();
+    auto* zi = im.data();
+
+    // the first stage has only the trivial twiddle
+    for (int i = 0; i < halfSize; i += 2)
+    {
+        auto br = zr[i + 1], bi = zi[i + 1];
+        zr[i + 1] = zr[i] - br;     zi[i + 1] = zi[i] - bi;
+        zr[i] += br;                zi[i] += bi;
+    }
+
+    const auto* twiddleRe = stageRe.data() + 1;
+    const auto* twiddleIm = stageIm.data() + 1;
+
+    for (int length = 4; length <= halfSize; length <<= 1)
+    {
+        auto half = length / 2;
+
+        for (int start = 0; start < halfSize; start += length)
+        {
+            auto* ar = zr + start;
+            auto* ai = zi + start;
+            auto* br = ar + half;
+            auto* bi = ai + half;
+
+            // unit stride through everything, so this is the loop that vectorizes
+            for (int j = 0; j < half; ++j)
+            {
+                auto wr = twiddleRe[j], wi = twiddleIm[j];
+                auto tr = br[j] * wr - bi[j] * wi;
+                auto ti = br[j] * wi + bi[j] * wr;
+
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+
+        twiddleRe += half;
+        twiddleIm += half;
+    }
+}
+
+void PortableRealFFT::performRealSpectrum(const float* data)
+{
+    // even samples in the real parts, odd ones in the imaginary parts, already in bit-reversed order
+    for (int i = 0; i < halfSize; ++i)
+    {
+        auto to = (size_t)reversed[(size_t)i];
+        re[to] = data[2 * i];
+        im[to] = data[2 * i + 1];
+    }
+
+    performComplex();
+
+    // with E and O the spectra of the even and odd samples and W = exp(-2 pi i / size):
+    // X[k] = E[k] + W^k O[k] and X[h - k] = conj(E[k] - W^k O[k]), where h = size / 2
+    auto dc = re[0] + im[0];
+    auto nyquist = re[0] - im[0];
+
+    for (int k = 1; k <= halfSize / 2; ++k)
+    {
+        auto m = (size_t)(halfSize - k);
+        auto n = (size_t)k;
+
+        auto er = 0.5f * (re[n] + re[m]), ei = 0.5f * (im[n] - im[m]);
+        auto orr = 0.5f * (im[n] + im[m]), oi = -0.5f * (re[n] - re[m]);
+
+        auto wr = splitRe[n], wi = splitIm[n];
+        auto tr = wr * orr - wi * oi;
+        auto ti = wr * oi + wi * orr;
+
+        re[n] = er + tr;    im[n] = ei + ti;
+        re[m] = er - tr;    im[m] = -(ei - ti);
+    }
+
+    // both are real, so they share the slot bin 0 leaves free
+    re[0] = dc;
+    im[0] = nyquist;
+}
+
+void PortableRealFFT::performRealMagnitudes(float* data)
+{
+    performRealSpectrum(data);
+
+    data[0] = std::abs(re[0]);
+
+    for (int k = 1; k < halfSize; ++k)
+        data[k] = std::sqrt(re[(size_t)k] * re[(size_t)k] + im[(size_t)k] * im[(size_t)k]);
+
+    data[halfSize] = std::abs(im[0]);
+}
+
+void PortableRealFFT::performRealForward(float* data)
+{
+    performRealSpectrum(data);
+
+    data[0] = re[0];
+    data[1] = 0.0f;
+
+    for (int k = 1; k < halfSize; ++k)
+    {
+        data[2 * k] = re[(size_t)k];
+        data[2 * k + 1] = im[(size_t)k];
+    }
+
+    data[2 * halfSize] = im[0];
+    data[2 * halfSize + 1] = 0.0f;
+}
+
+//==============================================================================
+std::unique_ptr<FFTBackend> FFTBackend::create(int order, int index)
+{
+    switch (index)
+    {
+        case 0:  return std::make_unique<JuceFFTBackend>(order);
+        case 1:  return std::make_unique<PortableRealFFT>(order);
+        default: jassertfalse; return nullptr;
+    }
+}
+
+std::vector<std::unique_ptr<FFTBackend>> FFTBackend::createAll(int order)
+{
+    std::vector<std::unique_ptr<FFTBackend>> backends;
+    for (int index = 0; index < numBackends; ++index)
+        backends.push_back(create(order, index));
+
+    return backends;
+}
+
+void FFTBackend::benchmark(int order)
+{
+    getFastestIndex(order);
+}
+
+std::unique_ptr<FFTBackend> FFTBackend::createFastest(int order)
+{
+    return create(order, getFastestIndex(order));
+}
+
+int FFTBackend::getFastestIndex(int order)
+{
+    static std::mutex lock;
+    static std::array<int, 32> choices = [] { std::array<int, 32> c; c.fill(-1); return c; }();
+
+    jassert(order > 1 && order < (int)choices.size());
+
+    const std::lock_guard<std::mutex> guard(lock);
+
+    // the backends are only built to be timed, the first time an order is asked for
+    if (choices[(size_t)order] < 0)
+        choices[(size_t)order] = runBenchmark(order);
+
+    return choices[(size_t)order];
+}
+
+int FFTBackend::runBenchmark(int order)
+{
+    auto backends = createAll(order);
+
+    auto size = 1 << order;
+    std::vector<float> input((size_t)size), output, bins, reference, referenceBins;
+
+    juce::Random random(order);
+    for (auto& sample : input)
+        sample = random.nextFloat() * 2.0f - 1.0f;
+
+    auto best = 0;
+    auto bestSeconds = 0.0;
+    auto repeats = juce::jmax(4, (1 << 16) / size);
+
+    for (size_t b = 0; b < backends.size(); ++b)
+    {
+        output = input;
+        backends[b]->performRealMagnitudes(output.data());
+        output.resize((size_t)(size / 2 + 1));
+
+        bins = input;
+        bins.resize((size_t)(size + 2));
+        backends[b]->performRealForward(bins.data());
+
+        // the first backend is the reference; one that disagrees with it never gets picked
+        if (b == 0)
+        {
+            reference = output;
+            referenceBins = bins;
+        }
+        else
+        {
+            auto peak = juce::FloatVectorOperations::findMaximum(reference.data(), (int)reference.size());
+            auto agrees = true;
+
+            for (size_t k = 0; k < reference.size(); ++k)
+                agrees = agrees && std::abs(output[k] - reference[k]) <= 1.0e-3f * peak;
+
+            for (size_t k = 0; k < referenceBins.size(); ++k)
+                agrees = agrees && std::abs(bins[k] - referenceBins[k]) <= 1.0e-3f * peak;
+
+            if (! agrees)
+            {
+                DBG("FFT backend " << backends[b]->getName() << " disagrees with " << backends[0]->getName() << " at order " << order);
+                continue;
+            }
+        }
+
+        output.resize((size_t)size);
+
+        // best of three, to shrug off a context switch; each repeat is one frame of each kind the
+        // pipelines ask for, magnitudes for mono and the complex bins for stereo
+        auto seconds = 0.0;
+        for (int run = 0; run < 3; ++run)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < repeats; ++i)
+            {
+                juce::FloatVectorOperations::copy(output.data(), input.data(), size);
+                backends[b]->performRealMagnitudes(output.data());
+
+                juce::FloatVectorOperations::copy(bins.data(), input.data(), size);
+                backends[b]->performRealForward(bins.data());
+            }
+
+            auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            seconds = run == 0 ? elapsed : juce::jmin(seconds, elapsed);
+        }
+
+        if (b == 0 || seconds < bestSeconds)
+        {
+            best = (int)b;
+            bestSeconds = seconds;
+        }
+    }
+
+    DBG("FFT backend for order " << order << ": " << backends[(size_t)best]->getName());
+    return best;
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    FFTBackend.h
+    Interchangeable real-input FFTs, and a start-up benchmark that picks the
+    fastest one for each size.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+    A forward FFT of real input that works in place, leaving the magnitudes
+    of bins 0..getSize() / 2 at the front of a getSize() buffer, or the bins
+    themselves across a getSize() + 2 one. Unscaled, like juce::dsp::FFT.
+
+    One instance per thread: a backend may keep scratch state of its own.
+*/
+struct FFTBackend
+{
+    virtual ~FFTBackend() = default;
+
+    virtual const char* getName() const = 0;
+    virtual int getOrder() const = 0;
+    int getSize() const { return 1 << getOrder(); }
+
+    /** data holds getSize() samples going in and getSize() / 2 + 1 magnitudes coming out. */
+    virtual void performRealMagnitudes(float* data) = 0;
+    /** data holds getSize() samples going in, with room for getSize() + 2, and bins 0 to getSize() / 2
+        coming out as interleaved real and imaginary parts. */
+    virtual void performRealForward(float* data) = 0;
+
+    /** Every backend this build has for order, in a fixed order. Not realtime safe. */
+    static std::vector<std::unique_ptr<FFTBackend>> createAll(int order);
+
+    /** Runs the benchmark for order unless this process already has, without keeping any backend.
+        Once it has, this is just a locked lookup. Not realtime safe. */
+    static void benchmark(int order);
+
+    /** The backend that came out fastest, and agreed with the others, when this order was first
+        benchmarked; only that one is built. The benchmark runs once per order per process, for a
+        few milliseconds. Not realtime safe. */
+    static std::unique_ptr<FFTBackend> createFastest(int order);
+
+private:
+    static constexpr int numBackends = 2;
+
+    /** Index into createAll()'s list of the backend chosen for order, benchmarking it first if need be. */
+    static int getFastestIndex(int order);
+    /** Times each of createAll(order), returning the index of the fastest that agrees with the first. */
+    static int runBenchmark(int order);
+    /** Just createAll(order)[index]. */
+    static std::unique_ptr<FFTBackend> create(int order, int index);
+};
+
+//==============================================================================
+/** juce::dsp::FFT, which wants a 2 * size buffer, so this one keeps it as scratch. */
+struct JuceFFTBackend : FFTBackend
+{
+    explicit JuceFFTBackend(int order);
+
+    const char* getName() const override { return "juce"; }
+    int getOrder() const override { return order; }
+    void performRealMagnitudes(float* data) override;
+    void performRealForward(float* data) override;
+
+private:
+    int order;
+    juce::dsp::FFT fft;
+    std::vector<float> scratch;
+};
+
+//==============================================================================
+/**
+    A size / 2 point complex FFT of the even and odd samples as real and
+    imaginary parts, then one split pass that turns it into the size point real
+    spectrum, and the magnitudes or complex bins written back over the front
+    of the caller's buffer.
+
+    The complex values are kept as separate real and imaginary arrays, filled
+    in bit-reversed order straight from the interleaved input, so every
+    butterfly loop walks four contiguous float arrays and a contiguous
+    per-stage twiddle table with unit stride. That is what lets the compiler
+    vectorize them on any target without intrinsics.
+*/
+struct PortableRealFFT : FFTBackend
+{
+    explicit PortableRealFFT(int order);
+
+    const char* getName() const override { return "portable"; }
+    int getOrder() const override { return order; }
+    void performRealMagnitudes(float* data) override;
+    void performRealForward(float* data) override;
+
+private:
+    int order, halfSize;
+    std::vector<int> reversed;                  // where each complex point goes in bit-reversed order
+    std::vector<float> stageRe, stageIm;        // exp(-2 pi i j / L) for j < L / 2, for each L in turn
+    std::vector<float> splitRe, splitIm;        // exp(-2 pi i k / size) for k <= size / 4
+    std::vector<float> re, im;                  // the size / 2 complex points, split
+
+    void performComplex();
+    void performRealSpectrum(const float* data);
+};
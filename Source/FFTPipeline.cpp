@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    FFTPipeline.cpp
+
+  ==============================================================================
+*/
+
+#include "FFTPipeline.h"
+#include "MultiResolutionFFTPipeline.h"
+
+//==============================================================================
+void FFTPipeline::prepare(double sampleRate, int numPoints, SpectrumMapper::Scale scale, SpectrumMapper::Aggregation aggregation)
+{
+    mapper.prepare(sampleRate, getSize(), numPoints, scale, aggregation);
+}
+
+std::unique_ptr<FFTPipeline> createFFTPipeline(int order, bool multiResolution)
+{
+    order = juce::jlimit(FFTPipeline::minOrder, FFTPipeline::maxOrder, order);
+
+    // each decimated band spans 4 times as many samples as the one above it
+    if (multiResolution)
+    {
+        switch (order)
+        {
+            case 9:  return std::make_unique<MultiResolutionFFTPipeline<9, 3>>();
+            case 10: return std::make_unique<MultiResolutionFFTPipeline<10, 2>>();
+            case 11: return std::make_unique<MultiResolutionFFTPipeline<11, 2>>();
+            case 12: return std::make_unique<MultiResolutionFFTPipeline<12, 1>>();
+            case 13: return std::make_unique<MultiResolutionFFTPipeline<13, 1>>();
+            default: break;   // already as long as a band may get
+        }
+    }
+
+    switch (order)
+    {
+        case 9:  return std::make_unique<FixedSizeFFTPipeline<9>>();
+        case 10: return std::make_unique<FixedSizeFFTPipeline<10>>();
+        case 11: return std::make_unique<FixedSizeFFTPipeline<11>>();
+        case 12: return std::make_unique<FixedSizeFFTPipeline<12>>();
+        case 13: return std::make_unique<FixedSizeFFTPipeline<13>>();
+        case 14: return std::make_unique<FixedSizeFFTPipeline<14>>();
+        case 15:
+        default: return std::make_unique<FixedSizeFFTPipeline<15>>();
+    }
+}
@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    FFTPipeline.h
+    The per-frame window -> FFT -> magnitude stage, specialized at compile
+    time for each supported FFT size.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <complex>
+#include <memory>
+#include <vector>
+#include "FFTBackend.h"
+#include "SampleRing.h"
+#include "SpectrumMapper.h"
+
+//==============================================================================
+/** What a stereo frame can add on top of the two channel spectra. */
+struct StereoSpectrum
+{
+    int numBins = 0;                // how many entries of each array the frame filled
+    std::vector<float> mid, side;   // magnitudes of (L + R) / 2 and (L - R) / 2
+    std::vector<float> phase;       // arg(L) - arg(R), in radians
+    std::vector<float> correlation; // -1..1, from the time-averaged cross spectrum
+
+    /** Not realtime safe. */
+    void allocate(int maxNumBins)
+    {
+        for (auto* v : { &mid, &side, &phase, &correlation })
+            v->resize((size_t)maxNumBins);
+    }
+};
+
+//==============================================================================
+/**
+    Everything whose size depends on the FFT order: window table, FFT buffers,
+    the stereo cross spectrum and the bin-to-point mapping.
+
+    Each order is its own FixedSizeFFTPipeline instantiation, so the buffers
+    are fixed-size arrays and the loops have compile-time trip counts; the
+    analysis job only ever sees this interface and swaps whole pipelines when
+    the order changes.
+*/
+struct FFTPipeline
+{
+    static constexpr int minOrder = 9;
+    static constexpr int maxOrder = 15;
+
+    virtual ~FFTPipeline() = default;
+
+    virtual int getOrder() const = 0;
+    int getSize() const { return 1 << getOrder(); }
+    int getNumBins() const { return getSize() / 2 + 1; }
+
+    /** Not realtime safe. */
+    virtual void prepare(double sampleRate, int numPoints, SpectrumMapper::Scale scale, SpectrumMapper::Aggregation aggregation);
+
+    /** Windows the oldest getSize() samples in the ring, in place, and leaves their magnitudes in getMagnitudes(). */
+    virtual void processMono(SampleRing& ring) = 0;
+    /** Both channels' magnitudes, each a real transform on the backend. With spectrum, the two channels'
+        complex bins also give it their mid/side, phase and correlation; while spectrum is nullptr the
+        cross spectrum isn't tracked either. */
+    virtual void processStereo(SampleRing& left, SampleRing& right, StereoSpectrum* spectrum) = 0;
+    /** Forgets the time-averaged cross spectrum. */
+    virtual void resetStereo() = 0;
+    /** Takes the place of processMono() or processStereo() for a window nobody will see (right is nullptr
+        for mono). Nothing is transformed, but state that follows the signal from frame to frame keeps up with it. */
+    virtual void skipFrame(SampleRing& left, SampleRing* right) { juce::ignoreUnused(left, right); }
+
+    virtual const float* getMagnitudes() const = 0;
+    virtual const float* getPartnerMagnitudes() const = 0;
+
+    /** The last frame of channel 0 (this analyzer) or 1 (the stereo partner) as numPoints display values. */
+    virtual void map(int channel, float* curve)
+    {
+        mapper.process(channel == 0 ? getMagnitudes() : getPartnerMagnitudes(), curve);
+    }
+
+protected:
+    SpectrumMapper mapper;
+};
+
+//==============================================================================
+template<int Order>
+struct FixedSizeFFTPipeline : FFTPipeline
+{
+    static_assert(Order >= minOrder && Order <= maxOrder, "unsupported FFT order");
+
+    static constexpr int size = 1 << Order;
+    static constexpr int numBins = size / 2 + 1;
+
+    FixedSizeFFTPipeline()
+    {
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t)size, juce::dsp::WindowingFunction<float>::hann);
+        resetStereo();
+    }
+
+    int getOrder() const override { return Order; }
+
+    void processMono(SampleRing& ring) override
+    {
+        readWindow(ring, data.data());
+        backend->performRealMagnitudes(data.data());
+    }
+
+    void processStereo(SampleRing& left, SampleRing& right, StereoSpectrum* spectrum) override
+    {
+        readWindow(left, data.data());
+        readWindow(right, partnerData.data());
+
+        // magnitudes are all most frames need; the cross-channel spectra need each channel's complex bins
+        if (spectrum == nullptr)
+        {
+            backend->performRealMagnitudes(data.data());
+            backend->performRealMagnitudes(partnerData.data());
+            return;
+        }
+
+        backend->performRealForward(data.data());
+        backend->performRealForward(partnerData.data());
+
+        constexpr float smoothing = 0.8f;
+
+        jassert((int)spectrum->mid.size() >= numBins);
+
+        // bin k's magnitude goes over slot k, which is behind the pair 2k, 2k + 1 this reads, so it's safe in place
+        for (int k = 0; k < numBins; ++k)
+        {
+            std::complex<float> l{ data[(size_t)(2 * k)], data[(size_t)(2 * k + 1)] };
+            std::complex<float> r{ partnerData[(size_t)(2 * k)], partnerData[(size_t)(2 * k + 1)] };
+
+            data[(size_t)k] = std::abs(l);
+            partnerData[(size_t)k] = std::abs(r);
+
+            auto cross = l * std::conj(r);
+            crossSpectrum[(size_t)k] = smoothing * crossSpectrum[(size_t)k] + (1.0f - smoothing) * cross;
+            leftPower[(size_t)k] = smoothing * leftPower[(size_t)k] + (1.0f - smoothing) * std::norm(l);
+            rightPower[(size_t)k] = smoothing * rightPower[(size_t)k] + (1.0f - smoothing) * std::norm(r);
+
+            spectrum->mid[(size_t)k] = std::abs(0.5f * (l + r));
+            spectrum->side[(size_t)k] = std::abs(0.5f * (l - r));
+            spectrum->phase[(size_t)k] = std::arg(cross);
+
+            auto power = std::sqrt(leftPower[(size_t)k] * rightPower[(size_t)k]);
+            spectrum->correlation[(size_t)k] = power > 1.0e-12f ? crossSpectrum[(size_t)k].real() / power : 0.0f;
+        }
+
+        spectrum->numBins = numBins;
+    }
+
+    void resetStereo() override
+    {
+        crossSpectrum.fill({});
+        leftPower.fill(0.0f);
+        rightPower.fill(0.0f);
+    }
+
+    const float* getMagnitudes() const override { return data.data(); }
+    const float* getPartnerMagnitudes() const override { return partnerData.data(); }
+
+private:
+    std::unique_ptr<FFTBackend> backend = FFTBackend::createFastest(Order);
+
+    std::array<float, size> window;
+    std::array<float, size + 2> data, partnerData;    // room for the complex bins a stereo frame needs
+    std::array<std::complex<float>, numBins> crossSpectrum;
+    std::array<float, numBins> leftPower, rightPower;
+
+    void readWindow(SampleRing& ring, float* dest)
+    {
+        // window the samples straight out of the ring into the FFT buffer, with no intermediate copy
+        auto span = ring.peek(size);
+
+        juce::FloatVectorOperations::multiply(dest, span.first, window.data(), span.firstSize);
+        juce::FloatVectorOperations::multiply(dest + span.firstSize, span.second, window.data() + span.firstSize, span.secondSize);
+    }
+};
+
+//==============================================================================
+/** A pipeline for any order from FFTPipeline::minOrder to maxOrder. multiResolution adds
+    decimated bands below it, as many as keep the longest under a 2^maxOrder sample span.
+    Not realtime safe. */
+std::unique_ptr<FFTPipeline> createFFTPipeline(int order, bool multiResolution = false);
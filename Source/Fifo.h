@@ -0,0 +1,388 @@
+/*
+  ==============================================================================
+
+    Fifo.h
+    Lock-free single-producer / single-consumer ring used by every stage of
+    the analyzer pipeline.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/** What a queue has seen since it was created. */
+struct QueueStats
+{
+    uint64_t pushed = 0;         // items accepted
+    uint64_t dropped = 0;        // items refused or lost because the queue was full
+    uint64_t peakOccupancy = 0;  // most items seen waiting at once
+    uint64_t starved = 0;        // consumer wakeups that found nothing waiting
+
+    QueueStats& operator+=(const QueueStats& other)
+    {
+        pushed += other.pushed;
+        dropped += other.dropped;
+        peakOccupancy = juce::jmax(peakOccupancy, other.peakOccupancy);
+        starved += other.starved;
+        return *this;
+    }
+};
+
+//==============================================================================
+/**
+    SPSC ring with a compile-time, power-of-two capacity.
+
+    The read and write counters run freely and are masked on access, so all
+    Capacity slots are usable. Each counter lives on its own cache line next to
+    the owning thread's cached copy of the other side's counter, which keeps the
+    producer and consumer from bouncing a shared line on every call.
+
+    Items can be moved one at a time (push/pull), in batches (push_n/pull_n),
+    or accessed in place without a copy:
+
+        if (auto* slot = fifo.write_slot()) { fill(*slot); fifo.commit(); }
+        if (auto* slot = fifo.read_slot())  { use(*slot);  fifo.release(); }
+
+    Each side also counts what it sees (pushes, drops, starvation, peak
+    occupancy) in counters only it writes, readable from any thread with
+    getStats(). Starvation is counted per wakeup, not per read: a consumer
+    calls noteWakeup() each time it comes to look, and only a first read
+    after that which finds the queue empty counts, so a drain loop that
+    ends on an empty queue isn't mistaken for a consumer left waiting.
+*/
+template<typename T, size_t Capacity>
+struct Fifo
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Fifo capacity must be a power of two");
+
+    static constexpr size_t getCapacity() { return Capacity; }
+
+    //==============================================================================
+    bool push(const T& itemToAdd)
+    {
+        auto* slot = write_slot();
+        if (slot == nullptr)
+            return false;
+
+        *slot = itemToAdd;
+        commit();
+        return true;
+    }
+    bool pull(T& itemToUpdate)
+    {
+        auto* slot = read_slot();
+        if (slot == nullptr)
+            return false;
+
+        itemToUpdate = *slot;
+        release();
+        return true;
+    }
+
+    /** Pushes up to num items and returns how many fitted. */
+    size_t push_n(const T* items, size_t num)
+    {
+        auto write = producer.index.load(std::memory_order_relaxed);
+        auto toWrite = juce::jmin(num, freeSpace(write, num));
+
+        for (size_t i = 0; i < toWrite; ++i)
+            buffer[(write + i) & Mask] = items[i];
+
+        producer.index.store(write + toWrite, std::memory_order_release);
+        bump(producer.succeeded, toWrite);
+        bump(producer.failed, num - toWrite);
+        return toWrite;
+    }
+    /** Pulls up to num items and returns how many were available. */
+    size_t pull_n(T* items, size_t num)
+    {
+        auto read = consumer.index.load(std::memory_order_relaxed);
+        auto ready = readySpace(read, num);
+        auto toRead = juce::jmin(num, ready);
+        notePeek(ready);
+
+        for (size_t i = 0; i < toRead; ++i)
+            items[i] = buffer[(read + i) & Mask];
+
+        consumer.index.store(read + toRead, std::memory_order_release);
+        return toRead;
+    }
+
+    //==============================================================================
+    /** Producer side: the next free slot, or nullptr when full. Publish it with commit(). */
+    T* write_slot()
+    {
+        auto write = producer.index.load(std::memory_order_relaxed);
+        if (freeSpace(write) > 0)
+            return &buffer[write & Mask];
+
+        bump(producer.failed, 1);
+        return nullptr;
+    }
+    void commit()
+    {
+        producer.index.store(producer.index.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        bump(producer.succeeded, 1);
+    }
+
+    /** Consumer side: the oldest ready slot, or nullptr when empty. Hand it back with release(). */
+    T* read_slot()
+    {
+        auto read = consumer.index.load(std::memory_order_relaxed);
+        auto ready = readySpace(read);
+        notePeek(ready);
+        return ready > 0 ? &buffer[read & Mask] : nullptr;
+    }
+    void release()
+    {
+        consumer.index.store(consumer.index.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /** Consumer side: the start of a pass over the queue, e.g. a timer tick. Reads without one never count as starved. */
+    void noteWakeup() { consumer.firstReadSinceWakeup = true; }
+
+    //==============================================================================
+    size_t getNumReady() const
+    {
+        return producer.index.load(std::memory_order_acquire) - consumer.index.load(std::memory_order_acquire);
+    }
+    size_t getFreeSpace() const { return Capacity - getNumReady(); }
+
+    QueueStats getStats() const
+    {
+        QueueStats stats;
+        stats.pushed = producer.succeeded.load(std::memory_order_relaxed);
+        stats.dropped = producer.failed.load(std::memory_order_relaxed);
+        stats.peakOccupancy = consumer.peak.load(std::memory_order_relaxed);
+        stats.starved = consumer.failed.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    /** Visits every slot, e.g. to preallocate them. Only call while neither side is running. */
+    template<typename Fn>
+    void forEachSlot(Fn&& fn)
+    {
+        for (auto& slot : buffer)
+            fn(slot);
+    }
+
+private:
+    static constexpr size_t Mask = Capacity - 1;
+    static constexpr size_t CacheLineSize = 64;
+
+    // Only reload the other side's counter when the cached copy can't satisfy the request.
+    size_t freeSpace(size_t write, size_t wanted = 1)
+    {
+        if (Capacity - (write - producer.cachedOther) < wanted)
+            producer.cachedOther = consumer.index.load(std::memory_order_acquire);
+
+        return Capacity - (write - producer.cachedOther);
+    }
+    size_t readySpace(size_t read, size_t wanted = 1)
+    {
+        if (consumer.cachedOther - read < wanted)
+            consumer.cachedOther = producer.index.load(std::memory_order_acquire);
+
+        return consumer.cachedOther - read;
+    }
+
+    // every counter has a single writer, so a relaxed load and store is enough
+    static void bump(std::atomic<uint64_t>& counter, size_t amount)
+    {
+        if (amount > 0)
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+    void notePeek(size_t ready)
+    {
+        if (ready == 0)
+        {
+            if (consumer.firstReadSinceWakeup)
+                bump(consumer.failed, 1);
+        }
+        else if (ready > consumer.peak.load(std::memory_order_relaxed))
+        {
+            consumer.peak.store(ready, std::memory_order_relaxed);
+        }
+
+        consumer.firstReadSinceWakeup = false;
+    }
+
+    struct alignas(CacheLineSize) Side
+    {
+        std::atomic<size_t> index{ 0 };
+        size_t cachedOther = 0;
+        bool firstReadSinceWakeup = false;   // only used on the consumer side
+        std::atomic<uint64_t> succeeded{ 0 }, failed{ 0 }, peak{ 0 };
+    };
+
+    Side producer, consumer;
+    alignas(CacheLineSize) std::array<T, Capacity> buffer;
+};
+
+//==============================================================================
+/**
+    A fixed set of preallocated frames whose ownership moves between two
+    threads by index, so a frame is filled once and never copied.
+
+    The producer acquire()s a free frame, fills it and publish()es its handle.
+    The consumer receive()s the handle, works on the frame in place for as
+    long as it likes and recycle()s it when done. Both directions are SPSC
+    rings of handles.
+*/
+template<typename T, size_t Capacity>
+struct FramePool
+{
+    using Handle = int;
+    static constexpr Handle invalidHandle = -1;
+
+    FramePool()
+    {
+        for (Handle h = 0; h < (Handle)Capacity; ++h)
+            freeFrames.push(h);
+    }
+
+    T& get(Handle h)
+    {
+        jassert(h >= 0 && h < (Handle)Capacity);
+        return frames[(size_t)h];
+    }
+
+    //==============================================================================
+    /** Producer side: takes a free frame, or returns invalidHandle when the consumer holds them all. */
+    Handle acquire()
+    {
+        // every acquire is a wakeup of its own, so each one that finds nothing counts as a lost frame
+        Handle h = invalidHandle;
+        freeFrames.noteWakeup();
+        freeFrames.pull(h);
+        return h;
+    }
+    void publish(Handle h) { readyFrames.push(h); }
+
+    /** Consumer side: marks the start of a pass of receive()s, for the starvation count. */
+    void noteWakeup() { readyFrames.noteWakeup(); }
+    /** Consumer side: the oldest published frame, if any. */
+    bool receive(Handle& h) { return readyFrames.pull(h); }
+    void recycle(Handle h) { freeFrames.push(h); }
+
+    /** Published frames; dropped counts acquire()s that found no free frame, so the frame was lost,
+        and starved the noteWakeup()s whose first receive() found nothing. */
+    QueueStats getStats() const
+    {
+        auto stats = readyFrames.getStats();
+        stats.dropped = freeFrames.getStats().starved;
+        return stats;
+    }
+
+    //==============================================================================
+    /** Only call while neither side is running. */
+    template<typename Fn>
+    void forEachFrame(Fn&& fn)
+    {
+        for (auto& frame : frames)
+            fn(frame);
+    }
+
+private:
+    std::array<T, Capacity> frames;
+    Fifo<Handle, Capacity> freeFrames, readyFrames;
+};
+
+//==============================================================================
+/**
+    Bounded multi-producer / multi-consumer queue (Vyukov's sequence-per-cell
+    design). Every operation is a single CAS on the shared position plus a
+    release store on the cell, so any thread, including the audio thread, can
+    push without locking.
+*/
+template<typename T, size_t Capacity>
+struct MpmcQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MpmcQueue capacity must be a power of two");
+
+    MpmcQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(const T& item)
+    {
+        auto pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+
+        for (;;)
+        {
+            cell = &cells[pos & Mask];
+            auto seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = (intptr_t)seq - (intptr_t)pos;
+
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        auto pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+
+        for (;;)
+        {
+            cell = &cells[pos & Mask];
+            auto seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+            if (diff == 0)
+            {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        item = cell->data;
+        cell->sequence.store(pos + Mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr size_t Mask = Capacity - 1;
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::array<Cell, Capacity> cells;
+    alignas(64) std::atomic<size_t> enqueuePos{ 0 };
+    alignas(64) std::atomic<size_t> dequeuePos{ 0 };
+};
@@ -0,0 +1,303 @@
+/*
+  ==============================================================================
+
+    FrameScheduler.cpp
+
+  ==============================================================================
+*/
+
+#include "FrameScheduler.h"
+
+//==============================================================================
+FrameScheduler::FrameScheduler()
+{
+    auto fromEnvironment = juce::SystemStats::getEnvironmentVariable("PFM_MAX_FRAME_RATE", {}).getDoubleValue();
+    if (fromEnvironment > 0.0)
+        setMaxFrameRate(fromEnvironment);
+}
+FrameScheduler::~FrameScheduler()
+{
+    // every client should have removed itself before the last reference went
+    jassert(registrations.isEmpty() && backgroundClients.isEmpty());
+    stopTimer();
+}
+void FrameScheduler::add(Client& client, juce::Component& onScreen)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    for (auto& registration : registrations)
+        if (registration.client == &client)
+            return;
+
+    registrations.add({ &client, &onScreen });
+    updateSource();
+}
+void FrameScheduler::remove(Client& client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    for (int i = registrations.size(); --i >= 0;)
+        if (registrations.getReference(i).client == &client)
+            registrations.remove(i);
+
+    updateSource();
+}
+void FrameScheduler::addBackground(Client& client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    backgroundClients.addIfNotAlreadyThere(&client);
+    updateSource();
+}
+void FrameScheduler::removeBackground(Client& client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    backgroundClients.removeAllInstancesOf(&client);
+    updateSource();
+}
+void FrameScheduler::setMaxFrameRate(double framesPerSecond)
+{
+    maxFrameRate = juce::jmax(minFrameRate, framesPerSecond);
+    frameRate = maxFrameRate;
+    lateFrames = 0;
+    onTimeSeconds = 0.0;
+    climbDelaySeconds = initialClimbDelaySeconds;
+    updateSource();
+}
+void FrameScheduler::updateSource()
+{
+    // the attachment can't be replaced from inside its own callback, so a change made by a client's tick waits for the batch to end
+    if (ticking)
+    {
+        sourceNeedsUpdate = true;
+        return;
+    }
+
+   #if PFM_FRAME_SCHEDULER_VBLANK
+    updateAnchor();
+   #endif
+    updateTimer();
+}
+bool FrameScheduler::isFollowingBlanks() const
+{
+   #if PFM_FRAME_SCHEDULER_VBLANK
+    return vblankAnchor != nullptr && ! blanksStalled;
+   #else
+    return false;
+   #endif
+}
+void FrameScheduler::updateTimer()
+{
+    // the timer drives the frames whenever there are no blanks to follow, wakes the background clients while
+    // there are no views, and otherwise only checks that the blanks keep coming
+    auto rate = 0.0;
+
+    if (registrations.isEmpty())
+        rate = backgroundClients.isEmpty() ? 0.0 : backgroundFrameRate;
+    else
+        rate = isFollowingBlanks() ? watchdogRate : frameRate;
+
+    if (rate <= 0.0)
+    {
+        stopTimer();
+        return;
+    }
+
+    // restarting a running timer would push its next callback back
+    auto interval = juce::roundToInt(1000.0 / rate);
+    if (! isTimerRunning() || getTimerInterval() != interval)
+        startTimer(interval);
+}
+#if PFM_FRAME_SCHEDULER_VBLANK
+void FrameScheduler::updateAnchor()
+{
+    // synced to the first registered component that's showing; a hidden or minimised one gets no blanks
+    juce::Component* anchor = nullptr;
+
+    for (auto& registration : registrations)
+    {
+        if (registration.component->isShowing())
+        {
+            anchor = registration.component;
+            break;
+        }
+    }
+
+    if (anchor == vblankAnchor)
+        return;
+
+    vblankAnchor = anchor;
+    blanksStalled = false;
+    lastBlankSeconds = juce::Time::getMillisecondCounterHiRes() * 0.001;
+
+    if (anchor == nullptr)
+        vblank.reset();
+    else
+        vblank = std::make_unique<juce::VBlankAttachment>(anchor, [this] { onBlank(); });
+}
+void FrameScheduler::onBlank()
+{
+    lastBlankSeconds = juce::Time::getMillisecondCounterHiRes() * 0.001;
+
+    // the blanks are back, so they take over from the timer again
+    if (blanksStalled)
+    {
+        blanksStalled = false;
+        updateTimer();
+    }
+
+    onFrame();
+}
+void FrameScheduler::checkBlanks()
+{
+    // a window that was minimised, or restored, doesn't tell its components, so the anchor is looked at again here
+    updateAnchor();
+
+    if (vblankAnchor == nullptr || blanksStalled)
+        return;
+
+    // a covered window can stop getting blanks while it still counts as showing; the attachment stays, in case they come back
+    if (juce::Time::getMillisecondCounterHiRes() * 0.001 - lastBlankSeconds > stallSeconds)
+        blanksStalled = true;
+
+    updateTimer();
+}
+#endif
+void FrameScheduler::timerCallback()
+{
+    if (registrations.isEmpty())
+    {
+        tickBackground();
+        return;
+    }
+
+   #if PFM_FRAME_SCHEDULER_VBLANK
+    checkBlanks();
+    if (isFollowingBlanks())
+        return;
+   #endif
+
+    onFrame();
+}
+void FrameScheduler::tickBackground()
+{
+    ticking = true;
+
+    for (int i = 0; i < backgroundClients.size(); ++i)
+        backgroundClients.getUnchecked(i)->frameTick();
+
+    ticking = false;
+
+    if (sourceNeedsUpdate)
+    {
+        sourceNeedsUpdate = false;
+        updateSource();
+    }
+}
+void FrameScheduler::onFrame()
+{
+    auto now = juce::Time::getMillisecondCounterHiRes() * 0.001;
+    measureSource(now);
+
+    auto interval = now - lastTickSeconds;
+
+    // a little early is fine: blanks jitter, and waiting for the next one would halve the rate
+    if (interval < 0.9 / frameRate)
+        return;
+
+    lastTickSeconds = now;
+    adaptRate(now, interval);
+
+    // by index, so a client removing itself (or another) part way through can't invalidate anything
+    ticking = true;
+
+    for (int i = 0; i < registrations.size(); ++i)
+        registrations.getReference(i).client->frameTick();
+
+    ticking = false;
+
+    // the background clients come last, in the same wakeup, and any change to the source waits for them
+    tickBackground();
+}
+void FrameScheduler::measureSource(double now)
+{
+    auto gap = now - lastCallbackSeconds;
+    lastCallbackSeconds = now;
+
+    // a gap across a pause says nothing about the source
+    if (gap <= 0.0 || gap > 1.0)
+        return;
+
+    windowMinimum = windowMinimum > 0.0 ? juce::jmin(windowMinimum, gap) : gap;
+
+    if (sourceInterval <= 0.0 || now - windowStartSeconds >= 1.0)
+    {
+        sourceInterval = windowMinimum;
+        windowMinimum = 0.0;
+        windowStartSeconds = now;
+    }
+}
+double FrameScheduler::getExpectedInterval() const
+{
+    if (sourceInterval <= 0.0)
+        return 1.0 / frameRate;
+
+    // onFrame() lets through the first callback at least 0.9 periods after the last tick, so a 75 Hz display capped at 60 ticks every second blank
+    auto callbacksPerTick = juce::jmax(1.0, std::ceil((0.9 / frameRate) / sourceInterval - 1.0e-3));
+    return callbacksPerTick * sourceInterval;
+}
+void FrameScheduler::adaptRate(double now, double interval)
+{
+    // after a pause the first interval is meaningless
+    if (interval > 1.0)
+        return;
+
+    // late means at least one of the source's callbacks went by that should have been a tick
+    auto expected = getExpectedInterval();
+    auto slack = sourceInterval > 0.0 ? 0.5 * sourceInterval : 0.5 * expected;
+
+    if (interval > expected + slack)
+    {
+        ++lateFrames;
+        onTimeSeconds = 0.0;
+    }
+    else
+    {
+        onTimeSeconds += interval;
+
+        // a full second on time forgives the odd hiccup before it
+        if (onTimeSeconds >= 1.0)
+            lateFrames = 0;
+    }
+
+    auto previousRate = frameRate;
+
+    if (lateFrames >= 8 && frameRate > minFrameRate)
+    {
+        frameRate = juce::jmax(minFrameRate, frameRate * 0.5);
+
+        // the last climb didn't hold, so don't be in such a hurry to try it again
+        if (now - lastClimbSeconds < 2.0 * climbDelaySeconds)
+            climbDelaySeconds = juce::jmin(maxClimbDelaySeconds, climbDelaySeconds * 2.0);
+
+        lateFrames = 0;
+        onTimeSeconds = 0.0;
+    }
+    else if (frameRate < maxFrameRate && onTimeSeconds >= climbDelaySeconds)
+    {
+        frameRate = juce::jmin(maxFrameRate, frameRate * 2.0);
+        lastClimbSeconds = now;
+        lateFrames = 0;
+        onTimeSeconds = 0.0;
+    }
+    else if (now - lastClimbSeconds > 4.0 * maxClimbDelaySeconds)
+    {
+        // it's been steady for long enough that the next dip is a new one
+        climbDelaySeconds = initialClimbDelaySeconds;
+    }
+
+    // a no-op unless the timer is what's driving the frames
+    if (frameRate != previousRate)
+        updateTimer();
+}
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    FrameScheduler.h
+    One process-wide display clock that every analyzer view is ticked from,
+    in a single batch per frame.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_MAJOR_VERSION > 6 || (JUCE_MAJOR_VERSION == 6 && JUCE_MINOR_VERSION >= 1)
+ #define PFM_FRAME_SCHEDULER_VBLANK 1
+#else
+ #define PFM_FRAME_SCHEDULER_VBLANK 0
+#endif
+
+//==============================================================================
+/**
+    Process-wide frame clock, shared through juce::SharedResourcePointer like
+    the AnalysisWorkerPool. Views register while they're showing and are all
+    ticked together, so however many editors are open the message thread
+    wakes once per frame and their repaints coalesce into one pass.
+
+    Frames follow the display's vertical blank through a juce::VBlankAttachment
+    on the first registered component that's showing (a timer where JUCE has
+    no VBlankAttachment), skipping blanks to stay under the frame-rate cap.
+    While that component is hidden or minimised the frames move to the next
+    one that's showing, and while none is, or the blanks stop coming because
+    the window is covered, a timer stands in until they're back. How
+    late a tick is gets judged against the blanks the source really delivers,
+    so a display whose refresh isn't a multiple of the cap doesn't look like
+    an overloaded one. If ticks keep missing blanks because the message
+    thread can't keep up, the rate halves, down to minFrameRate, and climbs
+    back towards the cap only after a stretch with no late frames at all; a
+    climb that doesn't hold makes the next one wait twice as long. So 60 fps
+    only happens where it's affordable, and the rate doesn't flap.
+
+    Background clients have nothing on screen but still want the message
+    thread now and then. They ride along at the end of each frame's batch,
+    and only while no view is registered does the scheduler wake up for
+    them, at backgroundFrameRate.
+
+    Message thread only. The cap starts at PFM_MAX_FRAME_RATE from the
+    environment if that is set, otherwise defaultMaxFrameRate.
+*/
+struct FrameScheduler : private juce::Timer
+{
+    static constexpr double defaultMaxFrameRate = 60.0;
+    static constexpr double minFrameRate = 15.0;
+    static constexpr double initialClimbDelaySeconds = 2.0, maxClimbDelaySeconds = 32.0;
+    static constexpr double backgroundFrameRate = 10.0;
+
+    struct Client
+    {
+        virtual ~Client() = default;
+        /** Called once per frame, in the same batch as every other client. */
+        virtual void frameTick() = 0;
+    };
+
+    FrameScheduler();
+    ~FrameScheduler() override;
+
+    /** onScreen is the client's own component; the first one registered that's showing is what the frames are synced to. */
+    void add(Client& client, juce::Component& onScreen);
+    void remove(Client& client);
+    /** A client ticked with the views, or on its own at backgroundFrameRate while there are none. */
+    void addBackground(Client& client);
+    void removeBackground(Client& client);
+
+    void setMaxFrameRate(double framesPerSecond);
+    double getMaxFrameRate() const { return maxFrameRate; }
+    /** The rate clients are actually ticked at: the cap, or less while the message thread is behind. */
+    double getFrameRate() const { return frameRate; }
+
+private:
+    struct Registration
+    {
+        Client* client = nullptr;
+        juce::Component* component = nullptr;
+    };
+
+    juce::Array<Registration> registrations;
+    juce::Array<Client*> backgroundClients;
+    double maxFrameRate = defaultMaxFrameRate;
+    double frameRate = defaultMaxFrameRate;
+    double lastTickSeconds = 0.0;
+
+    // the source's own period: the shortest gap between its callbacks over the last second, since a missed blank only lengthens one
+    double lastCallbackSeconds = 0.0, sourceInterval = 0.0;
+    double windowStartSeconds = 0.0, windowMinimum = 0.0;
+
+    int lateFrames = 0;
+    double onTimeSeconds = 0.0;
+    double climbDelaySeconds = initialClimbDelaySeconds, lastClimbSeconds = 0.0;
+    bool ticking = false, sourceNeedsUpdate = false;
+
+    // how often the timer checks on the blanks while they drive the frames, and how long a gap means they've stopped
+    static constexpr double watchdogRate = 4.0, stallSeconds = 0.5;
+
+   #if PFM_FRAME_SCHEDULER_VBLANK
+    std::unique_ptr<juce::VBlankAttachment> vblank;
+    juce::Component* vblankAnchor = nullptr;
+    double lastBlankSeconds = 0.0;
+    bool blanksStalled = false;
+
+    void updateAnchor();
+    void onBlank();
+    void checkBlanks();
+   #endif
+
+    bool isFollowingBlanks() const;
+    void updateSource();
+    void updateTimer();
+    void tickBackground();
+    void onFrame();
+    void measureSource(double now);
+    double getExpectedInterval() const;
+    void adaptRate(double now, double interval);
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE(FrameScheduler)
+};
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    LatencyMonitor.h
+    Per-frame timestamps and lock-free latency histograms for each stage
+    between the audio callback and the painted curve.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+
+//==============================================================================
+/** When one analyzer frame passed each stage, in high-resolution ticks. 0 means not stamped. */
+struct FrameTimestamps
+{
+    juce::int64 audio = 0;          // the audio callback that wrote the frame's newest sample
+    juce::int64 analysisStart = 0;  // a worker picked the frame up
+    juce::int64 published = 0;      // the curve was handed to the message thread
+    juce::int64 received = 0;       // the timer took it for display
+    bool painted = false;
+};
+
+//==============================================================================
+/**
+    Log-spaced histogram of latencies, four buckets per octave from 1 us, so
+    percentiles come back within about 9%. record() is a couple of relaxed
+    atomic adds and can be called from any thread; readers take whatever
+    counts are there at the time.
+*/
+struct LatencyHistogram
+{
+    static constexpr int bucketsPerOctave = 4;
+    static constexpr int numBuckets = 96;   // up to about 16 seconds
+
+    void record(double microseconds)
+    {
+        latestMs.store((float)(microseconds * 0.001), std::memory_order_relaxed);
+
+        auto bucket = microseconds > 1.0 ? (int)(std::log2(microseconds) * bucketsPerOctave) : 0;
+        counts[(size_t)juce::jmin(bucket, numBuckets - 1)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    float getLatestMs() const { return latestMs.load(std::memory_order_relaxed); }
+
+    juce::int64 getCount() const
+    {
+        juce::int64 total = 0;
+        for (const auto& count : counts)
+            total += count.load(std::memory_order_relaxed);
+
+        return total;
+    }
+
+    /** fraction is 0..1, e.g. 0.99 for p99. Returns 0 when nothing has been recorded. */
+    float getPercentileMs(double fraction) const
+    {
+        std::array<juce::int64, numBuckets> snapshot;
+        juce::int64 total = 0;
+
+        for (size_t b = 0; b < snapshot.size(); ++b)
+            total += (snapshot[b] = counts[b].load(std::memory_order_relaxed));
+
+        if (total == 0)
+            return 0.0f;
+
+        auto target = juce::jmax((juce::int64)1, (juce::int64)std::ceil(fraction * (double)total));
+        juce::int64 seen = 0;
+
+        for (size_t b = 0; b < snapshot.size(); ++b)
+        {
+            seen += snapshot[b];
+
+            // report the bucket's geometric centre
+            if (seen >= target)
+                return (float)(std::exp2(((double)b + 0.5) / bucketsPerOctave) * 0.001);
+        }
+
+        return (float)(std::exp2((double)numBuckets / bucketsPerOctave) * 0.001);
+    }
+
+    void reset()
+    {
+        for (auto& count : counts)
+            count.store(0, std::memory_order_relaxed);
+
+        latestMs.store(0.0f, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<juce::int64>, numBuckets> counts{};
+    std::atomic<float> latestMs{ 0.0f };
+};
+
+//==============================================================================
+/** One histogram per hop of the analyzer pipeline, plus the end-to-end total. */
+struct LatencyMonitor
+{
+    enum Stage
+    {
+        queued,     // audio callback -> worker starts the frame
+        analysis,   // window, FFT, mapping, smoothing and path building
+        delivery,   // published -> picked up by the analyzer's timer
+        display,    // picked up -> first painted
+        endToEnd,   // audio callback -> first painted
+        numStages
+    };
+
+    static const char* getStageName(int stage)
+    {
+        static const char* names[] = { "queued", "analysis", "delivery", "display", "end to end" };
+        return names[juce::jlimit(0, (int)numStages - 1, stage)];
+    }
+
+    static juce::int64 now() { return juce::Time::getHighResolutionTicks(); }
+
+    /** Does nothing if either end wasn't stamped. */
+    void record(Stage stage, juce::int64 fromTicks, juce::int64 toTicks)
+    {
+        if (fromTicks == 0 || toTicks == 0)
+            return;
+
+        auto seconds = juce::Time::highResolutionTicksToSeconds(toTicks - fromTicks);
+        stages[(size_t)stage].record(juce::jmax(0.0, seconds * 1.0e6));
+    }
+
+    const LatencyHistogram& get(Stage stage) const { return stages[(size_t)stage]; }
+
+    void reset()
+    {
+        for (auto& stage : stages)
+            stage.reset();
+    }
+
+private:
+    std::array<LatencyHistogram, numStages> stages;
+};
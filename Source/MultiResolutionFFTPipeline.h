@@ -0,0 +1,329 @@
+/*
+  ==============================================================================
+
+    MultiResolutionFFTPipeline.h
+    Long FFTs of a decimated signal for the bass, the usual FFT for the rest,
+    stitched into one display curve.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FFTPipeline.h"
+
+//==============================================================================
+/**
+    Lowpass and keep every 4th sample. 48 Blackman-windowed sinc taps put the
+    cutoff at the output's Nyquist and everything above 3/4 of the output rate
+    at least 70 dB down, so the bottom half of the output band, the part a
+    multi-resolution band actually draws, is clean.
+*/
+struct Decimator
+{
+    static constexpr int factor = 4;
+    static constexpr int numTaps = 48;
+
+    void reset()
+    {
+        history.fill(0.0f);
+        writeIndex = 0;
+        phase = 0;
+    }
+
+    /** Returns true, with output set, on every factor-th input. */
+    bool push(float input, float& output)
+    {
+        // every sample is written twice, so the newest numTaps are always contiguous
+        history[(size_t)writeIndex] = history[(size_t)(writeIndex + numTaps)] = input;
+        writeIndex = (writeIndex + 1) % numTaps;
+
+        if (++phase < factor)
+            return false;
+
+        phase = 0;
+
+        const auto& taps = getTaps();
+        const auto* newest = history.data() + writeIndex;
+        auto sum = 0.0f;
+
+        for (int i = 0; i < numTaps; ++i)
+            sum += taps[(size_t)i] * newest[i];
+
+        output = sum;
+        return true;
+    }
+
+private:
+    std::array<float, 2 * numTaps> history{};
+    int writeIndex = 0;
+    int phase = 0;
+
+    static const std::array<float, numTaps>& getTaps()
+    {
+        static const auto taps = []
+        {
+            std::array<float, numTaps> t;
+            auto centre = 0.5 * (numTaps - 1);
+            auto cutoff = 0.5 / factor;   // cycles per input sample
+            auto sum = 0.0;
+
+            for (int i = 0; i < numTaps; ++i)
+            {
+                auto x = (double)i - centre;
+                auto sinc = x == 0.0 ? 2.0 * cutoff : std::sin(2.0 * juce::MathConstants<double>::pi * cutoff * x) / (juce::MathConstants<double>::pi * x);
+                auto phi = 2.0 * juce::MathConstants<double>::pi * (double)i / (numTaps - 1);
+                auto blackman = 0.42 - 0.5 * std::cos(phi) + 0.08 * std::cos(2.0 * phi);
+
+                t[(size_t)i] = (float)(sinc * blackman);
+                sum += sinc * blackman;
+            }
+
+            // unity gain at DC, so every band reads the same level for the same sine
+            for (auto& tap : t)
+                tap = (float)(tap / sum);
+
+            return t;
+        }();
+
+        return taps;
+    }
+};
+
+//==============================================================================
+/**
+    Bands 1..NumDecimatedBands each see the signal decimated by another factor
+    of 4 through a cascade of Decimators, and run the same size FFT as the
+    full-rate band 0, so each band down has 4 times the frequency resolution
+    over 4 times the time span. Band b, running at rate fs / 4^b, draws the
+    display points from its rate / 16 up to the band above's crossover, its
+    rate / 4; that is the bottom half of its own band, where the decimation
+    filter is flat and alias free. So band 0 draws everything above fs / 16,
+    band 1 from fs / 64 to fs / 16, and the lowest band everything below its
+    crossover.
+
+    Band 0 runs on every hop the job asks for, stereo spectrum and all. The
+    decimated bands are fed incrementally from the samples each frame adds,
+    frames the job skips included,
+    and only transform again once a quarter of their own window is new, so
+    the low end updates less often and costs a fraction of one longer FFT.
+*/
+template<int Order, int NumDecimatedBands>
+struct MultiResolutionFFTPipeline : FFTPipeline
+{
+    static_assert(NumDecimatedBands >= 1, "use FixedSizeFFTPipeline for a single band");
+
+    static constexpr int size = 1 << Order;
+    static constexpr int numBins = size / 2 + 1;
+    static constexpr int numBands = NumDecimatedBands + 1;
+
+    MultiResolutionFFTPipeline()
+    {
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t)size, juce::dsp::WindowingFunction<float>::hann);
+        reset();
+    }
+
+    int getOrder() const override { return Order; }
+
+    void prepare(double sampleRate, int numPoints, SpectrumMapper::Scale scale, SpectrumMapper::Aggregation aggregation) override
+    {
+        // the same point edges SpectrumMapper would use for the whole curve
+        auto minFrequency = 20.0f;
+        auto maxFrequency = juce::jlimit(minFrequency + 1.0f, (float)sampleRate * 0.5f, 20000.0f);
+        auto scaleMin = SpectrumMapper::frequencyToScale(minFrequency, scale);
+        auto scaleMax = SpectrumMapper::frequencyToScale(maxFrequency, scale);
+
+        auto edgeFrequency = [&](int edge)
+        {
+            return SpectrumMapper::scaleToFrequency(juce::jmap((float)edge, 0.0f, (float)numPoints, scaleMin, scaleMax), scale);
+        };
+
+        // a point belongs to the lowest band that covers all of it
+        auto upperPoint = numPoints;
+        auto bandRate = sampleRate;
+
+        for (int b = 0; b < numBands; ++b)
+        {
+            auto lowerPoint = 0;
+
+            if (b < NumDecimatedBands)
+            {
+                auto crossover = (float)(bandRate / (4.0 * Decimator::factor));
+                while (lowerPoint < upperPoint && edgeFrequency(lowerPoint + 1) <= crossover)
+                    ++lowerPoint;
+            }
+
+            auto& range = ranges[(size_t)b];
+            range.firstPoint = lowerPoint;
+            range.numPoints = upperPoint - lowerPoint;
+
+            if (range.numPoints > 0)
+                range.mapper.prepare(bandRate, size, range.numPoints, scale, aggregation,
+                                     b == NumDecimatedBands ? minFrequency : edgeFrequency(lowerPoint),
+                                     edgeFrequency(upperPoint));
+
+            upperPoint = lowerPoint;
+            bandRate /= Decimator::factor;
+        }
+    }
+
+    void processMono(SampleRing& ring) override
+    {
+        full.processMono(ring);
+        feed(ring, nullptr);
+    }
+
+    void processStereo(SampleRing& left, SampleRing& right, StereoSpectrum* spectrum) override
+    {
+        full.processStereo(left, right, spectrum);
+        feed(left, &right);
+    }
+
+    void resetStereo() override { full.resetStereo(); }
+
+    void skipFrame(SampleRing& left, SampleRing* right) override
+    {
+        // the decimators still need every sample, or the next frame would find a gap and start the low bands from silence
+        pushNewSamples(left, right);
+    }
+
+    const float* getMagnitudes() const override { return full.getMagnitudes(); }
+    const float* getPartnerMagnitudes() const override { return full.getPartnerMagnitudes(); }
+
+    void map(int channel, float* curve) override
+    {
+        for (int b = 0; b < numBands; ++b)
+        {
+            auto& range = ranges[(size_t)b];
+            if (range.numPoints == 0)
+                continue;
+
+            const float* magnitudes = b == 0 ? (channel == 0 ? full.getMagnitudes() : full.getPartnerMagnitudes())
+                                             : bands[(size_t)b - 1].magnitudes[(size_t)channel].data();
+
+            range.mapper.process(magnitudes, curve + range.firstPoint);
+        }
+    }
+
+private:
+    /** The display points one band draws. */
+    struct PointRange
+    {
+        SpectrumMapper mapper;
+        int firstPoint = 0, numPoints = 0;
+    };
+
+    /** A circular history per channel at the band's rate, and the decimators feeding it from the band above. */
+    struct DecimatedBand
+    {
+        std::array<Decimator, 2> decimators;
+        std::array<std::array<float, size>, 2> samples;
+        std::array<std::array<float, size>, 2> magnitudes;
+        int writeIndex = 0;
+        int newSamples = 0;
+    };
+
+    FixedSizeFFTPipeline<Order> full;
+    std::unique_ptr<FFTBackend> backend = FFTBackend::createFastest(Order);
+    std::array<float, size> window;
+    std::array<PointRange, numBands> ranges;
+    std::array<DecimatedBand, NumDecimatedBands> bands;
+    juce::int64 nextInputPosition = -1;
+    int numChannels = 1;
+
+    void reset()
+    {
+        for (auto& band : bands)
+        {
+            for (auto& channel : band.samples)
+                channel.fill(0.0f);
+            for (auto& channel : band.magnitudes)
+                channel.fill(0.0f);
+            for (auto& decimator : band.decimators)
+                decimator.reset();
+
+            band.writeIndex = 0;
+            band.newSamples = 0;
+        }
+    }
+
+    /** Pushes the samples this frame added since the last one down the decimator cascade, then
+        transforms the bands that have enough new samples. */
+    void feed(SampleRing& left, SampleRing* right)
+    {
+        pushNewSamples(left, right);
+
+        for (auto& band : bands)
+        {
+            // a quarter of the window is new, i.e. 75% overlap at the band's own rate
+            if (band.newSamples < size / 4)
+                continue;
+
+            band.newSamples = 0;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                transform(band, ch);
+        }
+    }
+
+    void pushNewSamples(SampleRing& left, SampleRing* right)
+    {
+        auto frameStart = left.getReadPosition();
+        auto frameEnd = frameStart + size;
+        auto channels = right != nullptr ? 2 : 1;
+
+        // a skipped backlog, a re-prepared ring or a switch between mono and stereo breaks the history
+        if (nextInputPosition < frameStart || nextInputPosition > frameEnd || channels != numChannels)
+        {
+            reset();
+            nextInputPosition = frameStart;
+            numChannels = channels;
+        }
+
+        auto offset = (int)(nextInputPosition - frameStart);
+        nextInputPosition = frameEnd;
+
+        std::array<SampleRing::Span, 2> spans{ left.peek(size), right != nullptr ? right->peek(size) : SampleRing::Span{} };
+
+        for (int i = offset; i < size; ++i)
+        {
+            // both channels go through in step, so their decimators emit on the same sample
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const auto& span = spans[(size_t)ch];
+                pushDown(ch, i < span.firstSize ? span.first[i] : span.second[i - span.firstSize]);
+            }
+        }
+    }
+
+    void pushDown(int channel, float sample)
+    {
+        for (auto& band : bands)
+        {
+            if (! band.decimators[(size_t)channel].push(sample, sample))
+                return;
+
+            band.samples[(size_t)channel][(size_t)band.writeIndex] = sample;
+
+            // the last channel moves the shared write position on
+            if (channel == numChannels - 1)
+            {
+                band.writeIndex = (band.writeIndex + 1) & (size - 1);
+                ++band.newSamples;
+            }
+        }
+    }
+
+    void transform(DecimatedBand& band, int channel)
+    {
+        // oldest first: the history wraps at writeIndex
+        const auto& history = band.samples[(size_t)channel];
+        auto& data = band.magnitudes[(size_t)channel];
+        auto firstSize = size - band.writeIndex;
+
+        juce::FloatVectorOperations::multiply(data.data(), history.data() + band.writeIndex, window.data(), firstSize);
+        juce::FloatVectorOperations::multiply(data.data() + firstSize, history.data(), window.data() + firstSize, band.writeIndex);
+
+        backend->performRealMagnitudes(data.data());
+    }
+};
@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    NoiseGenerator.cpp
+
+  ==============================================================================
+*/
+
+#include "NoiseGenerator.h"
+
+namespace
+{
+    // the top 23 bits become the mantissa of a float in [1, 2)
+    inline float toUnitInterval(uint32_t x)
+    {
+        auto bits = (x >> 9) | 0x3f800000u;
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+}
+
+//==============================================================================
+void NoiseGenerator::prepare(double sampleRate, int maxNumChannels)
+{
+    channels.resize((size_t)maxNumChannels);
+
+    auto& random = juce::Random::getSystemRandom();
+
+    for (auto& channel : channels)
+    {
+        channel = {};
+
+        // xorshift must never be seeded with 0
+        for (auto& lane : channel.lanes)
+            lane = (uint32_t)random.nextInt() | 1u;
+    }
+
+    gain.reset(sampleRate, 0.02);
+    gain.setCurrentAndTargetValue(0.0f);
+}
+
+void NoiseGenerator::process(juce::AudioBuffer<float>& buffer, bool enabled, Colour colour)
+{
+    auto numSamples = buffer.getNumSamples();
+    auto numChannels = juce::jmin(buffer.getNumChannels(), (int)channels.size());
+
+    gain.setTargetValue(enabled ? 1.0f : 0.0f);
+
+    // fully off: nothing to generate
+    if (! gain.isSmoothing() && gain.getCurrentValue() == 0.0f)
+    {
+        buffer.clear();
+        return;
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& state = channels[(size_t)ch];
+        auto* samples = buffer.getWritePointer(ch);
+
+        // white keeps the original nextFloat() range; the filters need a signal without DC
+        fillWhite(state, samples, numSamples, colour == Colour::white);
+
+        if (colour == Colour::pink)
+            filterPink(state, samples, numSamples);
+        else if (colour == Colour::brown)
+            filterBrown(state, samples, numSamples);
+    }
+
+    for (int ch = numChannels; ch < buffer.getNumChannels(); ++ch)
+        buffer.clear(ch, 0, numSamples);
+
+    auto startGain = gain.getCurrentValue();
+    gain.skip(numSamples);
+    auto endGain = gain.getCurrentValue();
+
+    if (startGain != 1.0f || endGain != 1.0f)
+        buffer.applyGainRamp(0, numSamples, startGain, endGain);
+}
+
+//==============================================================================
+void NoiseGenerator::fillWhite(ChannelState& state, float* dest, int numSamples, bool unipolar)
+{
+    // [1, 2) maps to [0, 1) or [-1, 1) without a branch in the loop
+    auto scale = unipolar ? 1.0f : 2.0f;
+    auto offset = unipolar ? -1.0f : -3.0f;
+    auto lanes = state.lanes;
+    int i = 0;
+
+    for (; i + numLanes <= numSamples; i += numLanes)
+    {
+        for (int l = 0; l < numLanes; ++l)
+        {
+            auto x = lanes[(size_t)l];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            lanes[(size_t)l] = x;
+            dest[i + l] = scale * toUnitInterval(x) + offset;
+        }
+    }
+
+    // a partial group at the end of the block
+    for (int l = 0; i < numSamples; ++i, ++l)
+    {
+        auto x = lanes[(size_t)l];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        lanes[(size_t)l] = x;
+        dest[i] = scale * toUnitInterval(x) + offset;
+    }
+
+    state.lanes = lanes;
+}
+
+void NoiseGenerator::filterPink(ChannelState& state, float* samples, int numSamples)
+{
+    // Paul Kellet's economy pink filter, scaled back to roughly unit peak
+    auto b0 = state.pink0, b1 = state.pink1, b2 = state.pink2;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto white = samples[i];
+        b0 = 0.99765f * b0 + white * 0.0990460f;
+        b1 = 0.96300f * b1 + white * 0.2965164f;
+        b2 = 0.57000f * b2 + white * 1.0526913f;
+        samples[i] = 0.25f * (b0 + b1 + b2 + white * 0.1848f);
+    }
+
+    state.pink0 = b0;
+    state.pink1 = b1;
+    state.pink2 = b2;
+}
+
+void NoiseGenerator::filterBrown(ChannelState& state, float* samples, int numSamples)
+{
+    // leaky integrator, so it can't drift off to DC
+    auto b = state.brown;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        b = (b + 0.02f * samples[i]) * (1.0f / 1.02f);
+        samples[i] = 3.5f * b;
+    }
+
+    state.brown = b;
+}
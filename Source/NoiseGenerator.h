@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    NoiseGenerator.h
+    Block-based white, pink and brown noise test signal.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+/**
+    Fills whole channels at a time. White noise comes from several independent
+    xorshift32 generators advanced in lock-step, so the inner loop is plain
+    shifts and xors over an array that the compiler vectorizes. White noise is
+    in [0, 1), the same range as the juce::Random::nextFloat() signal it
+    replaced; pink and brown are filtered per channel from a bipolar [-1, 1)
+    source, since the filters would integrate the DC of a unipolar one.
+    On/off switching goes through a short gain ramp so toggling the test
+    signal doesn't click.
+*/
+struct NoiseGenerator
+{
+    enum class Colour
+    {
+        white,
+        pink,
+        brown
+    };
+
+    /** Not realtime safe. */
+    void prepare(double sampleRate, int maxNumChannels);
+
+    /** Overwrites every channel of the buffer. Parameters are read once per call. */
+    void process(juce::AudioBuffer<float>& buffer, bool enabled, Colour colour);
+
+private:
+    static constexpr int numLanes = 8;
+
+    struct ChannelState
+    {
+        std::array<uint32_t, numLanes> lanes;
+        float pink0 = 0.0f, pink1 = 0.0f, pink2 = 0.0f;
+        float brown = 0.0f;
+    };
+
+    std::vector<ChannelState> channels;
+    juce::SmoothedValue<float> gain;
+
+    static void fillWhite(ChannelState& state, float* dest, int numSamples, bool unipolar);
+    static void filterPink(ChannelState& state, float* samples, int numSamples);
+    static void filterBrown(ChannelState& state, float* samples, int numSamples);
+};
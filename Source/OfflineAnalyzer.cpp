@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    OfflineAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "OfflineAnalyzer.h"
+#include "FFTPipeline.h"
+#include "SampleRing.h"
+#include <atomic>
+#include <functional>
+#include <thread>
+
+//==============================================================================
+namespace
+{
+    /** Everything one worker owns, so workers share nothing but the chunk counter while they run. */
+    struct OfflineWorker
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader;
+        std::unique_ptr<FFTPipeline> pipeline;
+        juce::AudioBuffer<float> chunk;
+        SampleRing ring;
+        std::vector<float> curve;
+
+        // per channel, then per channel and point
+        std::vector<double> sumSquares;
+        std::vector<float> peak;
+        std::vector<double> powerSums;
+        std::vector<float> maxGain;
+    };
+}
+
+//==============================================================================
+juce::String OfflineAnalyzer::analyze(const juce::File& file, const Settings& settings, Result& result)
+{
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    auto* format = formats.findFormatForFileExtension(file.getFileExtension());
+    if (format == nullptr)
+        return "unsupported file type: " + file.getFileName();
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> probe(format->createMemoryMappedReader(file));
+    if (probe == nullptr)
+        return format->getFormatName() + " files can't be memory-mapped: " + file.getFileName();
+
+    auto order = juce::jlimit(FFTPipeline::minOrder, FFTPipeline::maxOrder, settings.fftOrder);
+    auto size = 1 << order;
+    // a hop longer than the window would leave gaps between frames, and chunks can't overlap by a negative amount
+    auto hop = settings.hopSize > 0 ? juce::jmin(settings.hopSize, size) : size / 2;
+    auto numChannels = (int)probe->numChannels;
+    auto numPoints = juce::jmax(1, settings.numPoints);
+    auto length = probe->lengthInSamples;
+
+    if (length < size)
+        return "shorter than one " + juce::String(size) + " sample window: " + file.getFileName();
+
+    result = {};
+    result.sampleRate = probe->sampleRate;
+    result.numChannels = numChannels;
+    result.lengthInSamples = length;
+    result.fftSize = size;
+    result.hopSize = hop;
+    result.numPoints = numPoints;
+    result.numFrames = 1 + (length - size) / hop;
+
+    auto numFrames = result.numFrames;
+    auto numValues = (size_t)numChannels * (size_t)numPoints;
+
+    if (settings.keepSpectra)
+        result.spectra.resize(numValues * (size_t)numFrames);
+
+    SpectrumMapper mapper;
+    mapper.prepare(result.sampleRate, size, numPoints, settings.scale, settings.aggregation);
+    for (int point = 0; point < numPoints; ++point)
+        result.pointFrequencies.push_back(mapper.getFrequencyForPoint(point));
+
+    //==============================================================================
+    // chunks overlap by size - hop samples, so every frame lies wholly inside one chunk
+    auto framesPerChunk = (juce::int64)juce::jmax(1, settings.framesPerChunk);
+    auto numChunks = (numFrames + framesPerChunk - 1) / framesPerChunk;
+    auto maxChunkSamples = (int)((framesPerChunk - 1) * hop + size + hop);   // the last chunk also owns the tail
+
+    auto numWorkers = settings.numThreads > 0 ? settings.numThreads : juce::SystemStats::getNumCpus();
+    numWorkers = (int)juce::jlimit((juce::int64)1, numChunks, (juce::int64)numWorkers);
+
+    std::vector<OfflineWorker> workers((size_t)numWorkers);
+    for (auto& worker : workers)
+    {
+        worker.reader.reset(format->createMemoryMappedReader(file));
+        if (worker.reader == nullptr)
+            return "couldn't open " + file.getFileName();
+
+        worker.pipeline = createFFTPipeline(order);
+        worker.pipeline->prepare(result.sampleRate, numPoints, settings.scale, settings.aggregation);
+        worker.chunk.setSize(numChannels, maxChunkSamples);
+        worker.ring.prepare(maxChunkSamples);
+        worker.curve.resize((size_t)numPoints);
+        worker.sumSquares.resize((size_t)numChannels, 0.0);
+        worker.peak.resize((size_t)numChannels, 0.0f);
+        worker.powerSums.resize(numValues, 0.0);
+        worker.maxGain.resize(numValues, 0.0f);
+    }
+
+    std::atomic<juce::int64> nextChunk{ 0 };
+    std::atomic<bool> failed{ false };
+
+    auto runWorker = [&](OfflineWorker& worker)
+    {
+        for (auto c = nextChunk++; c < numChunks && ! failed; c = nextChunk++)
+        {
+            auto firstFrame = c * framesPerChunk;
+            auto endFrame = juce::jmin(numFrames, firstFrame + framesPerChunk);
+
+            // samples the chunk's frames read, and the ones it counts towards peak and RMS
+            auto start = firstFrame * hop;
+            auto ownedEnd = endFrame == numFrames ? length : endFrame * hop;
+            auto end = juce::jmax((endFrame - 1) * hop + size, ownedEnd);
+            auto numSamples = (int)(end - start);
+
+            if (! worker.reader->mapSectionOfFile({ start, end })
+                || ! worker.reader->read(worker.chunk.getArrayOfWritePointers(), numChannels, start, numSamples))
+            {
+                failed = true;
+                return;
+            }
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* samples = worker.chunk.getReadPointer(ch);
+                auto numOwned = (int)(ownedEnd - start);
+
+                auto range = juce::FloatVectorOperations::findMinAndMax(samples, numOwned);
+                worker.peak[(size_t)ch] = juce::jmax(worker.peak[(size_t)ch], -range.getStart(), range.getEnd());
+
+                auto sum = 0.0;
+                for (int i = 0; i < numOwned; ++i)
+                    sum += (double)samples[i] * (double)samples[i];
+                worker.sumSquares[(size_t)ch] += sum;
+
+                // the pipeline reads windows out of a ring, exactly as the live job does
+                worker.ring.write(samples, numSamples);
+
+                auto* powerSums = worker.powerSums.data() + (size_t)ch * (size_t)numPoints;
+                auto* maxGain = worker.maxGain.data() + (size_t)ch * (size_t)numPoints;
+                auto toGain = 1.0f / (float)size;
+
+                for (auto frame = firstFrame; frame < endFrame; ++frame)
+                {
+                    worker.pipeline->processMono(worker.ring);
+                    worker.pipeline->map(0, worker.curve.data());
+                    worker.ring.advance(hop);
+
+                    // the summary stays linear, so it costs no logs; only kept frames are converted to dB
+                    for (int point = 0; point < numPoints; ++point)
+                    {
+                        auto gain = worker.curve[(size_t)point] * toGain;
+                        powerSums[point] += (double)(gain * gain);
+                        maxGain[point] = juce::jmax(maxGain[point], gain);
+                    }
+
+                    if (settings.keepSpectra)
+                    {
+                        auto* dest = result.spectra.data() + ((size_t)ch * (size_t)numFrames + (size_t)frame) * (size_t)numPoints;
+
+                        for (int point = 0; point < numPoints; ++point)
+                            dest[point] = juce::Decibels::gainToDecibels(worker.curve[(size_t)point] * toGain, settings.mindB);
+                    }
+                }
+
+                worker.ring.advance(worker.ring.getNumReady());
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers.size(); ++w)
+        threads.emplace_back(runWorker, std::ref(workers[w]));
+
+    runWorker(workers[0]);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    if (failed)
+        return "couldn't read " + file.getFileName();
+
+    //==============================================================================
+    result.peak.assign((size_t)numChannels, 0.0f);
+    result.rms.assign((size_t)numChannels, 0.0f);
+    result.averagedB.assign(numValues, 0.0f);
+    result.maxdB.assign(numValues, settings.mindB);
+
+    std::vector<double> powerSums(numValues, 0.0);
+    std::vector<float> maxGain(numValues, 0.0f);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto sumSquares = 0.0;
+
+        for (auto& worker : workers)
+        {
+            sumSquares += worker.sumSquares[(size_t)ch];
+            result.peak[(size_t)ch] = juce::jmax(result.peak[(size_t)ch], worker.peak[(size_t)ch]);
+        }
+
+        result.rms[(size_t)ch] = (float)std::sqrt(sumSquares / (double)length);
+    }
+
+    for (auto& worker : workers)
+    {
+        for (size_t i = 0; i < numValues; ++i)
+        {
+            powerSums[i] += worker.powerSums[i];
+            maxGain[i] = juce::jmax(maxGain[i], worker.maxGain[i]);
+        }
+    }
+
+    for (size_t i = 0; i < numValues; ++i)
+    {
+        result.averagedB[i] = juce::jmax(settings.mindB, (float)(10.0 * std::log10(powerSums[i] / (double)numFrames + 1.0e-30)));
+        result.maxdB[i] = juce::Decibels::gainToDecibels(maxGain[i], settings.mindB);
+    }
+
+    return {};
+}
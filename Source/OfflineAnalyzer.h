@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    OfflineAnalyzer.h
+    The analyzer's spectral analysis run over a whole audio file on every
+    core, without playing it through a host.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "SpectrumMapper.h"
+
+//==============================================================================
+/**
+    Analyzes a file with the same window, FFT and bin-to-point mapping as the
+    live analyzer, frame for frame.
+
+    The file is memory-mapped, split into chunks of framesPerChunk frames that
+    overlap by one window minus one hop, and the chunks are handed out to one
+    worker per core. Each worker maps only its chunk's section of the file
+    and runs its own FFTPipeline over it, so nothing is shared while they run.
+    Only formats JUCE can memory-map (WAV and AIFF) are supported.
+
+    Levels are in dB on the live analyzer's scale (magnitude over FFT size)
+    but before its ballistics: there is no smoothing or peak hold, since
+    those depend on every frame before.
+*/
+struct OfflineAnalyzer
+{
+    struct Settings
+    {
+        int fftOrder = 11;                  // FFTPipeline::minOrder to maxOrder
+        int hopSize = 0;                    // 0 means half the FFT size; anything over the FFT size is limited to it
+        int numPoints = 512;
+        SpectrumMapper::Scale scale = SpectrumMapper::Scale::logarithmic;
+        SpectrumMapper::Aggregation aggregation = SpectrumMapper::Aggregation::max;
+        float mindB = -100.0f;              // levels are clamped to this
+        int numThreads = 0;                 // 0 means one per core
+        int framesPerChunk = 256;
+        bool keepSpectra = false;           // every frame's levels too, numChannels * numFrames * numPoints floats; otherwise only the summary
+    };
+
+    struct Result
+    {
+        double sampleRate = 0.0;
+        int numChannels = 0;
+        juce::int64 lengthInSamples = 0;
+        int fftSize = 0, hopSize = 0, numPoints = 0;
+        juce::int64 numFrames = 0;
+
+        /** numChannels * numFrames * numPoints levels in dB, channel-major; empty unless keepSpectra. */
+        std::vector<float> spectra;
+
+        std::vector<float> pointFrequencies;    // centre of each display point, in Hz
+
+        // per channel
+        std::vector<float> peak, rms;           // of the samples, linear
+        // numChannels * numPoints
+        std::vector<float> averagedB, maxdB;    // each point's power average and maximum over all frames
+
+        const float* getFrame(int channel, juce::int64 frame) const
+        {
+            return spectra.data() + ((size_t)channel * (size_t)numFrames + (size_t)frame) * (size_t)numPoints;
+        }
+    };
+
+    /** Blocks until the whole file is analyzed. Returns an error message, or an empty string on success. */
+    static juce::String analyze(const juce::File& file, const Settings& settings, Result& result);
+};
@@ -12,22 +12,33 @@
 //==============================================================================
 PFMProject0AudioProcessorEditor::PFMProject0AudioProcessorEditor 
     (PFMProject0AudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p),
+      leftAnalyzer (p.leftAnalysisEngine),
+      rightAnalyzer (p.rightAnalysisEngine),
+      leftSpectrogram (p.leftAnalysisEngine),
+      rightSpectrogram (p.rightAnalysisEngine)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
     cachedBgColor = audioProcessor.bgColor->get();
     PFMProject0AudioProcessor::UpdateAutomatableParameter(audioProcessor.playSound, true);
 
-    addAndMakeVisible(audioProcessor.leftBufferAnalyzer);
-    addAndMakeVisible(audioProcessor.rightBufferAnalyzer);
+    addAndMakeVisible(leftAnalyzer);
+    addAndMakeVisible(rightAnalyzer);
 
-    audioProcessor.leftBufferAnalyzer.setInterceptsMouseClicks(false, false);
-    audioProcessor.rightBufferAnalyzer.setInterceptsMouseClicks(false, false);
+    leftAnalyzer.setInterceptsMouseClicks(false, false);
+    rightAnalyzer.setInterceptsMouseClicks(false, false);
 
+    addChildComponent(leftSpectrogram);
+    addChildComponent(rightSpectrogram);
+    leftSpectrogram.setInterceptsMouseClicks(false, false);
+    rightSpectrogram.setInterceptsMouseClicks(false, false);
+
+
+    setWantsKeyboardFocus(true);
 
     setSize (400, 300);
-    startTimerHz(20);
+    scheduler->add(*this, *this);
 }
 
 PFMProject0AudioProcessorEditor::~PFMProject0AudioProcessorEditor()
@@ -35,17 +46,23 @@ PFMProject0AudioProcessorEditor::~PFMProject0AudioProcessorEditor()
 //    audioProcessor.playSound->beginChangeGesture();
 //    audioProcessor.playSound->setValueNotifyingHost(false) ;
 //    audioProcessor.playSound->endChangeGesture();
+    scheduler->remove(*this);
     PFMProject0AudioProcessor::UpdateAutomatableParameter(audioProcessor.playSound, false);
 }
 
-void PFMProject0AudioProcessorEditor::timerCallback()
+void PFMProject0AudioProcessorEditor::frameTick()
 {
     update();
 }
 
 void PFMProject0AudioProcessorEditor::update()
 {
-    cachedBgColor = audioProcessor.bgColor->get();
+    // the analyzers repaint themselves; the whole editor only needs to when the background has changed
+    auto bgColor = audioProcessor.bgColor->get();
+    if (bgColor == cachedBgColor)
+        return;
+
+    cachedBgColor = bgColor;
     repaint();
 }
 
@@ -60,12 +77,72 @@ void PFMProject0AudioProcessorEditor::paint (juce::Graphics& g)
     g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
+void PFMProject0AudioProcessorEditor::paintOverChildren (juce::Graphics& g)
+{
+    if (! showLatencyOverlay)
+        return;
+
+    auto& monitor = audioProcessor.latencyMonitor;
+    auto lineHeight = 14;
+    auto area = juce::Rectangle<int>(4, 4, 260, lineHeight * (LatencyMonitor::numStages + 1) + 8);
+
+    g.setColour(juce::Colours::black.withAlpha(0.7f));
+    g.fillRect(area);
+
+    g.setColour(juce::Colours::white);
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+
+    auto row = area.reduced(4).removeFromTop(lineHeight);
+    g.drawText("stage          now    p50    p99 ms", row, juce::Justification::centredLeft);
+
+    for (int stage = 0; stage < LatencyMonitor::numStages; ++stage)
+    {
+        const auto& histogram = monitor.get((LatencyMonitor::Stage)stage);
+
+        row.translate(0, lineHeight);
+        g.drawText(juce::String(LatencyMonitor::getStageName(stage)).paddedRight(' ', 12)
+                       + juce::String(histogram.getLatestMs(), 1).paddedLeft(' ', 7)
+                       + juce::String(histogram.getPercentileMs(0.5), 1).paddedLeft(' ', 7)
+                       + juce::String(histogram.getPercentileMs(0.99), 1).paddedLeft(' ', 7),
+                   row, juce::Justification::centredLeft);
+    }
+}
+
+bool PFMProject0AudioProcessorEditor::keyPressed (const juce::KeyPress& key)
+{
+    if (key.getTextCharacter() == 'l' || key.getTextCharacter() == 'L')
+    {
+        showLatencyOverlay = ! showLatencyOverlay;
+        repaint();
+        return true;
+    }
+
+    if (key.getTextCharacter() == 's' || key.getTextCharacter() == 'S')
+    {
+        setShowSpectrogram(! leftSpectrogram.isVisible());
+        return true;
+    }
+
+    return false;
+}
+
+void PFMProject0AudioProcessorEditor::setShowSpectrogram(bool shouldShow)
+{
+    // each view detaches from its engine while hidden, so only what's on screen gets produced
+    leftSpectrogram.setVisible(shouldShow);
+    rightSpectrogram.setVisible(shouldShow);
+    leftAnalyzer.setVisible(! shouldShow);
+    rightAnalyzer.setVisible(! shouldShow);
+}
+
 void PFMProject0AudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
-    audioProcessor.leftBufferAnalyzer.setBounds(0, 0, getWidth(), getHeight() * 0.5);
-    audioProcessor.rightBufferAnalyzer.setBounds(0, getHeight()*0.5, getWidth(), getHeight() * 0.5);
+    leftAnalyzer.setBounds(0, 0, getWidth(), getHeight() * 0.5);
+    rightAnalyzer.setBounds(0, getHeight()*0.5, getWidth(), getHeight() * 0.5);
+    leftSpectrogram.setBounds(leftAnalyzer.getBounds());
+    rightSpectrogram.setBounds(rightAnalyzer.getBounds());
 
 }
 
@@ -9,6 +9,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "FrameScheduler.h"
+#include "SpectrogramView.h"
 //#include "PluginProcessor.h"
 
 //==============================================================================
@@ -16,7 +18,7 @@
 */
 struct PFMProject0AudioProcessorEditor;
 
-class PFMProject0AudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Timer
+class PFMProject0AudioProcessorEditor  : public juce::AudioProcessorEditor, public FrameScheduler::Client
 {
 public:
     PFMProject0AudioProcessorEditor (PFMProject0AudioProcessor&);
@@ -24,12 +26,14 @@ public:
 
     //==============================================================================
     void paint (juce::Graphics&) override;
+    void paintOverChildren (juce::Graphics&) override;
     void resized() override;
+    bool keyPressed (const juce::KeyPress& key) override;
 
     void mouseUp(const juce::MouseEvent& e) override;
     void mouseDown(const juce::MouseEvent& e) override;
     void mouseDrag(const juce::MouseEvent& e) override;
-    void timerCallback() override;
+    void frameTick() override;
 
 private:
     void update();
@@ -37,6 +41,11 @@ private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     PFMProject0AudioProcessor& audioProcessor;
+    juce::SharedResourcePointer<FrameScheduler> scheduler;
     float cachedBgColor = 0.f;
+    bool showLatencyOverlay = false;   // toggled with 'L'
+    BufferAnalyzer leftAnalyzer, rightAnalyzer;          // the engines stop when the editor closes
+    SpectrogramView leftSpectrogram, rightSpectrogram;   // shown instead of the curves with 'S'
+    void setShowSpectrogram(bool shouldShow);
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PFMProject0AudioProcessorEditor)
 };
@@ -9,372 +9,125 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-//==============================================================================
-void VariableSizedBuffer::clone(const juce::dsp::AudioBlock<float>& other)
-{
-    clear(other);
-
-    buffer.copyFrom(0,0, other.getChannelPointer(0), (int)other.getNumSamples());
-    numSamples = other.getNumSamples();
-}
-void VariableSizedBuffer::clone(const juce::AudioBuffer<float>& other)
+namespace
 {
-    clear(other);
-
-    buffer.copyFrom(0, 0, other, 0, 0, other.getNumSamples());
-    numSamples = other.getNumSamples();
+    // the overlapParam choices, as fractions of the FFT size
+    const std::array<float, 4> analysisOverlaps{ 0.0f, 0.5f, 0.75f, 0.875f };
 }
-void VariableSizedBuffer::clone(const VariableSizedBuffer& other)
-{
-    clear(other);
 
-    buffer.copyFrom(0, 0, other.buffer, 0, 0, (int) other.numSamples);
-
-    numSamples = other.numSamples;
-}
 //==============================================================================
-void BufferAnalyzer::prepare(double sampleRate, int samplesPerBlock)
+BufferAnalyzer::BufferAnalyzer(AnalysisEngine& e) :
+    engine(e), pathPool(e.getCurves())
 {
-    vsbFifo.prepare(samplesPerBlock);
-    fftCopyThread.prepare(samplesPerBlock);
 }
-void BufferAnalyzer::cloneBuffer(const juce::dsp::AudioBlock<float>& other)
+BufferAnalyzer::~BufferAnalyzer()
 {
-    if (vsbFifo.push(other))
-    {
-        fftCopyThread.notify();
-    }
+    scheduler->remove(*this);
+    if (attached)
+        engine.detach(AnalysisConsumers::curve, attachedRate);
+    if (currentPath != PathPool::invalidHandle)
+        pathPool.recycle(currentPath);
 }
-void BufferAnalyzer::timerCallback()
+void BufferAnalyzer::visibilityChanged()
 {
-    if (pathFifo.pull(fftCurve))
-    {
-        //auto tx = fftCurve.getTransformToScaleToFit(getLocalBounds().toFloat(), false);
-        //fftCurve.applyTransform(tx);
-        auto pathBounds = fftCurve.getBounds();
+    auto showing = isShowing();
+    if (showing == attached)
+        return;
 
-        fftCurve.applyTransform(juce::AffineTransform().scale( float(getWidth()) / pathBounds.getWidth(), getHeight() ));
-        repaint();
-    }
-}
-void BufferAnalyzer::paint(juce::Graphics& g)
-{
+    attached = showing;
 
-    //g.fillAll(juce::Colours::black);
-    //g.setColour(juce::Colours::white);
-
-    juce::ColourGradient cg;
-
-    auto colours = std::vector<juce::Colour>
-    {
-        juce::Colours::violet,
-        juce::Colours::blue,
-        juce::Colours::green,
-        juce::Colours::yellow,
-        juce::Colours::orange,
-        juce::Colours::red,
-        juce::Colours::white
-    };
-
-    for (int i = 0; i < colours.size(); ++i)
+    if (showing)
     {
-        cg.addColour(double(i) / double(colours.size() - 1), colours[i]);
+        // whatever was left from the last time we were watching is too old to draw
+        PathPool::Handle h;
+        while (pathPool.receive(h))
+            pathPool.recycle(h);
+
+        attachedRate = scheduler->getFrameRate();
+        engine.attach(AnalysisConsumers::curve, attachedRate);
+        scheduler->add(*this, *this);
     }
-
-    cg.point1 = { 0, (float)getHeight() };
-    cg.point2 = { 0, 0 };
-
-    g.setGradientFill(cg);
-    g.strokePath(fftCurve, juce::PathStrokeType(1));
-}
-//==============================================================================
-FFTProcessingThread::FFTProcessingThread(FFTDataFfio& fifo, PathFifo& pf) :
-    Thread("FFTProcessingThread"), fftDataFifo(fifo), pathFifo(pf)
-{
-    startThread();
-}
-FFTProcessingThread::~FFTProcessingThread()
-{
-    notify();
-    stopThread(100);
-}
-void FFTProcessingThread::run()
-{
-    while (true)
+    else
     {
-        wait(-1);
-
-        if (threadShouldExit())
-            break;
-
-        if (fftDataFifo.pull(fftData))
-        {
-            // first apply a windowing function to our data
-            window.multiplyWithWindowingTable(fftData.data(), FFTSizes::fftSize);       // [1]
-
-            // then render our FFT data..
-            forwardFFT.performFrequencyOnlyForwardTransform(fftData.data());  // [2]
-
-            auto mindB = -100.0f;
-            auto maxdB = 0.0f;
-
-            if (threadShouldExit())
-                return;
-
-            for (int i = 0; i < FFTSizes::numPoints; ++i)                         // [3]
-            {
-                auto skewedProportionX = 1.0f - std::exp(std::log(1.0f - (float)i / (float)FFTSizes::numPoints) * 0.2f);
-                auto fftDataIndex = juce::jlimit(0, FFTSizes::fftSize / 2, (int)(skewedProportionX * (float)FFTSizes::fftSize * 0.5f));
-                auto level = juce::jmap(juce::jlimit(mindB, maxdB, juce::Decibels::gainToDecibels(fftData[fftDataIndex])
-                    - juce::Decibels::gainToDecibels((float)FFTSizes::fftSize)),
-                    mindB, maxdB, 0.0f, 1.0f);
-
-                curveData[i] = level;                                   // [4]
-            }
-            if (threadShouldExit())
-                break;
-            //Make path
-
-
-            juce::Path fftCurve;
-
-            fftCurve.startNewSubPath(0, 0.5f);
-
-            for (int i = 4; i < FFTSizes::numPoints; ++i)
-            {
-                fftCurve.lineTo(float(i), juce::jmap(curveData[i], 0.f, 1.f, 1.f, 0.f));
-
-            }
-
-            if (threadShouldExit())
-                break;
+        engine.detach(AnalysisConsumers::curve, attachedRate);
+        scheduler->remove(*this);
 
-            pathFifo.push(fftCurve);
-
-        }
+        if (currentPath != PathPool::invalidHandle)
+            pathPool.recycle(currentPath);
+        currentPath = PathPool::invalidHandle;
     }
 }
-//==============================================================================
-FFTCopyThread::FFTCopyThread(VariableSizedBufferFifo& vsb, PathFifo& pf) : Thread("FFTCopyThread"),
-vsbFifo(vsb), fftProcessingThread(fftDataFifo, pf)
-{
-
-}
-
-FFTCopyThread::~FFTCopyThread()
+void BufferAnalyzer::parentHierarchyChanged()
 {
-    notify();
-    stopThread(100);
+    visibilityChanged();
 }
-
-void FFTCopyThread::run()
+void BufferAnalyzer::frameTick()
 {
-    while (true)
+    // follow the scheduler when it changes rate, attaching at the new one first so the engine never idles in between
+    auto rate = scheduler->getFrameRate();
+    if (rate != attachedRate)
     {
-        wait(-1);
-
-        if (threadShouldExit())
-            break;
-
-        if (vsbFifo.pull(buffer))
-        {
-            auto* ptr = buffer.getBuffer().getReadPointer(0);
-            auto num = buffer.getNumSamples();
-
-            if (threadShouldExit())
-                return;
-
-            for (size_t i = 0; i < num; ++i)
-            {
-                if (fifoIndex == FFTSizes::fftSize)
-                {
-                    if (threadShouldExit())
-                        return;
-
-                    fftData.fill({});
-                    juce::FloatVectorOperations::copy(fftData.data(), fifoBuffer.data(), (int)fifoBuffer.size());
-
-                    fftDataFifo.push(fftData);
-                    fftProcessingThread.notify();
-
-                    fifoIndex = 0;
-                }
-                fifoBuffer[fifoIndex++] = *(ptr + i);
-            }
-        }
+        engine.attach(AnalysisConsumers::curve, rate);
+        engine.detach(AnalysisConsumers::curve, attachedRate);
+        attachedRate = rate;
     }
-}
-
-void FFTCopyThread::prepare(int samples)
-{
-    buffer.prepare(samples);
-    startThread();
-}
-//==============================================================================
-BufferAnalyzer2::BufferAnalyzer2() : Thread("BufferAnalyzer")
-{
-    startThread();
-    startTimerHz(20);
 
-    fftCurve.preallocateSpace(3 * FFTSizes::numPoints);
-}
-
-BufferAnalyzer2::~BufferAnalyzer2()
-{
-    notify();
-    stopThread(100);
-}
-void BufferAnalyzer2::prepare(double sampleRate, int samplesPerBlock)
-{
-    firstBuffer = true;
-    buffers[0].setSize(1, samplesPerBlock);
-    buffers[1].setSize(1, samplesPerBlock);
-
-    samplesCopied[0].set(0);
-    samplesCopied[1].set(0);
-
-
-    fifoIndex = 0;
-    juce::zeromem(fifoBuffer, sizeof(fifoBuffer));
-    juce::zeromem(fftData, sizeof(fftData));
-    juce::zeromem(curveData, sizeof(curveData));
-
-}
-void BufferAnalyzer2::cloneBuffer(const juce::dsp::AudioBlock<float> &other)
-{
-    auto whichIndex = firstBuffer.get();
-    auto index = whichIndex ? 0 : 1;
-    firstBuffer.set(!whichIndex);
-
-    jassert(other.getNumChannels() == buffers[index].getNumChannels());
-    jassert(other.getNumSamples() <= buffers[index].getNumSamples());
-
-    buffers[index].clear();
-
-    juce::dsp::AudioBlock<float> buffer(buffers[index]);
-    buffer.copyFrom(other);
-
-    samplesCopied[index].set(other.getNumSamples());
+    // settings the audio thread asked for are applied on this tick rather than a clock of the engine's own
+    engine.applyPendingSettings();
 
-    notify();
-}
-
-void BufferAnalyzer2::run()
-{
-    while(true)
+    // keep only the newest curve, handing the one we were showing back to the pool
+    PathPool::Handle newest = PathPool::invalidHandle;
+    PathPool::Handle h;
+    pathPool.noteWakeup();
+    while (pathPool.receive(h))
     {
-        wait(-1);
-
-        DBG("BufferAnalyzer::run() awake!");
-
-        if (threadShouldExit())
-            break;
-
-        auto index = !firstBuffer.get() ? 0 : 1;
-
-        auto numSamples = samplesCopied[index].get();
-        auto* readPtr = buffers[index].getReadPointer(0);
-        for (int i = 0; i < numSamples; ++i)
-        {
-            //pushNextSampleIntoFifo(buffers[index].getSample(0, i));
-            // get sample is slow use pointer
-            pushNextSampleIntoFifo(*(readPtr + i));
-        }
+        if (newest != PathPool::invalidHandle)
+            pathPool.recycle(newest);
+        newest = h;
     }
-}
 
-void BufferAnalyzer2::pushNextSampleIntoFifo(float sample)
-{
-    if (fifoIndex == FFTSizes::fftSize)
+    if (newest != PathPool::invalidHandle)
     {
-        if (nextFFTBlockReady.get() == false)
-        {
-            juce::zeromem(fftData, sizeof(fftData));
-            memcpy(fftData, fifoBuffer, sizeof(fifoBuffer));
-            nextFFTBlockReady.set(true);
-        }
-        fifoIndex = 0;
-    }
-    fifoBuffer[fifoIndex++] = sample;
-}
+        if (currentPath != PathPool::invalidHandle)
+            pathPool.recycle(currentPath);
+        currentPath = newest;
+
+        auto& frame = pathPool.get(currentPath);
+        frame.timestamps.received = LatencyMonitor::now();
+        if (auto* latencyMonitor = engine.getLatencyMonitor())
+            latencyMonitor->record(LatencyMonitor::delivery, frame.timestamps.published, frame.timestamps.received);
 
-void BufferAnalyzer2::timerCallback()
-{
-    if (nextFFTBlockReady.get())
-    {
-        drawNextFrameOfSpectrum();
-        nextFFTBlockReady.set(false);
         repaint();
     }
 }
-
-void BufferAnalyzer2::drawNextFrameOfSpectrum()
+void BufferAnalyzer::resized()
 {
-    // first apply a windowing function to our data
-    window.multiplyWithWindowingTable(fftData, FFTSizes::fftSize);       // [1]
-
-    // then render our FFT data..
-    forwardFFT.performFrequencyOnlyForwardTransform(fftData);  // [2]
-
-    auto mindB = -100.0f;
-    auto maxdB = 0.0f;
-
-    for (int i = 0; i < FFTSizes::numPoints; ++i)                         // [3]
-    {
-        auto skewedProportionX = 1.0f - std::exp(std::log(1.0f - (float)i / (float)FFTSizes::numPoints) * 0.2f);
-        auto fftDataIndex = juce::jlimit(0, FFTSizes::fftSize / 2, (int)(skewedProportionX * (float)FFTSizes::fftSize * 0.5f));
-        auto level = juce::jmap(juce::jlimit(mindB, maxdB, juce::Decibels::gainToDecibels(fftData[fftDataIndex])
-            - juce::Decibels::gainToDecibels((float)FFTSizes::fftSize)),
-            mindB, maxdB, 0.0f, 1.0f);
-
-        curveData[i] = level;                                   // [4]
-    }
+    engine.setCurveSize(getWidth(), getHeight());
 }
-
-void BufferAnalyzer2::paint(juce::Graphics& g)
+void BufferAnalyzer::paint(juce::Graphics& g)
 {
-    float w = getWidth();
-    float h = getHeight();
+    if (currentPath == PathPool::invalidHandle)
+        return;
 
-    fftCurve.clear();
+    auto& frame = pathPool.get(currentPath);
 
-    fftCurve.startNewSubPath(0, juce::jmap(curveData[0], 0.f, 1.f, h, 0.f) );
+    // the worker already stroked the curve; a frame made before a resize is stretched until the next one arrives
+    if (! frame.image.isValid())
+        return;
 
-    for (int i = 1; i < FFTSizes::numPoints; ++i)
-    {
-        auto data = curveData[i];
-        auto endX = juce::jmap((float)i, 0.f, float(FFTSizes::numPoints), 0.f, w);
-        auto endY = juce::jmap(data, 0.f, 1.f, h, 0.f);
-
-        fftCurve.lineTo(endX, endY);
-    }
+    if (frame.image.getBounds() == getLocalBounds())
+        g.drawImageAt(frame.image, 0, 0);
+    else
+        g.drawImage(frame.image, getLocalBounds().toFloat());
 
-    g.fillAll(juce::Colours::black);
-    //g.setColour(juce::Colours::white);
-
-    juce::ColourGradient cg;
-
-    auto colours = std::vector<juce::Colour>
-    {
-        juce::Colours::violet,
-        juce::Colours::blue,
-        juce::Colours::green,
-        juce::Colours::yellow,
-        juce::Colours::orange,
-        juce::Colours::red,
-        juce::Colours::white
-    };
-
-    for (int i = 0; i < colours.size(); ++i)
+    auto* latencyMonitor = engine.getLatencyMonitor();
+    if (latencyMonitor != nullptr && ! frame.timestamps.painted)
     {
-        cg.addColour(double(i) / double(colours.size()-1), colours[i]);
+        auto now = LatencyMonitor::now();
+        latencyMonitor->record(LatencyMonitor::display, frame.timestamps.received, now);
+        latencyMonitor->record(LatencyMonitor::endToEnd, frame.timestamps.audio, now);
+        frame.timestamps.painted = true;
     }
-
-    cg.point1 = { 0, h };
-    cg.point2 = { 0, 0 };
-
-    g.setGradientFill(cg);
-    g.strokePath(fftCurve, juce::PathStrokeType(1));
 }
 //==============================================================================
 PFMProject0AudioProcessor::PFMProject0AudioProcessor()
@@ -402,7 +155,57 @@ PFMProject0AudioProcessor::PFMProject0AudioProcessor()
     param = apvts.createAndAddParameter(std::move(bgColorParam));
     bgColor = dynamic_cast<juce::AudioParameterFloat*>(param);
 
+    auto noiseColourParam = std::make_unique<juce::AudioParameterChoice>("Noise Colour", "noise colour", juce::StringArray{ "White", "Pink", "Brown" }, 0);
+    param = apvts.createAndAddParameter(std::move(noiseColourParam));
+    noiseColour = dynamic_cast<juce::AudioParameterChoice*>(param);
+
+    juce::StringArray fftSizeChoices;
+    for (auto order = FFTPipeline::minOrder; order <= FFTPipeline::maxOrder; ++order)
+        fftSizeChoices.add(juce::String(1 << order));
+
+    auto fftSizeChoice = std::make_unique<juce::AudioParameterChoice>("FFT Size", "fft size", fftSizeChoices, FFTSizes::fftOrder - FFTPipeline::minOrder);
+    param = apvts.createAndAddParameter(std::move(fftSizeChoice));
+    fftSizeParam = dynamic_cast<juce::AudioParameterChoice*>(param);
+
+    auto multiResolutionParam = std::make_unique<juce::AudioParameterBool>("Multi Resolution", "multi resolution", false);
+    param = apvts.createAndAddParameter(std::move(multiResolutionParam));
+    multiResolution = dynamic_cast<juce::AudioParameterBool*>(param);
+
+    auto overlapChoice = std::make_unique<juce::AudioParameterChoice>("Overlap", "overlap", juce::StringArray{ "0%", "50%", "75%", "87.5%" }, 1);
+    param = apvts.createAndAddParameter(std::move(overlapChoice));
+    overlapParam = dynamic_cast<juce::AudioParameterChoice*>(param);
+
+    auto frequencyScaleParam = std::make_unique<juce::AudioParameterChoice>("Frequency Scale", "frequency scale", juce::StringArray{ "Log", "Mel", "Bark" }, 0);
+    param = apvts.createAndAddParameter(std::move(frequencyScaleParam));
+    frequencyScale = dynamic_cast<juce::AudioParameterChoice*>(param);
+
+    auto aggregationParam = std::make_unique<juce::AudioParameterChoice>("Aggregation", "aggregation", juce::StringArray{ "Max", "Mean" }, 0);
+    param = apvts.createAndAddParameter(std::move(aggregationParam));
+    aggregation = dynamic_cast<juce::AudioParameterChoice*>(param);
+
+    SpectrumSmoother::Ballistics defaultBallistics;
+
+    auto attackParam = std::make_unique<juce::AudioParameterFloat>("Attack", "attack ms", juce::NormalisableRange<float>(1.f, 500.f, 0.f, 0.5f), defaultBallistics.attackMs);
+    param = apvts.createAndAddParameter(std::move(attackParam));
+    attackMs = dynamic_cast<juce::AudioParameterFloat*>(param);
+
+    auto releaseParam = std::make_unique<juce::AudioParameterFloat>("Release", "release ms", juce::NormalisableRange<float>(10.f, 3000.f, 0.f, 0.5f), defaultBallistics.releaseMs);
+    param = apvts.createAndAddParameter(std::move(releaseParam));
+    releaseMs = dynamic_cast<juce::AudioParameterFloat*>(param);
+
+    auto peakHoldParam = std::make_unique<juce::AudioParameterFloat>("Peak Hold", "peak hold ms", juce::NormalisableRange<float>(0.f, 5000.f, 0.f, 0.5f), defaultBallistics.peakHoldMs);
+    param = apvts.createAndAddParameter(std::move(peakHoldParam));
+    peakHoldMs = dynamic_cast<juce::AudioParameterFloat*>(param);
+
     apvts.state = juce::ValueTree("PFMSynthValueTree");
+
+    leftAnalysisEngine.setLatencyMonitor(&latencyMonitor);
+    rightAnalysisEngine.setLatencyMonitor(&latencyMonitor);
+    leftAnalysisEngine.setOutputs(0, &spectrumCapture, &sharedSpectrum);
+    rightAnalysisEngine.setOutputs(1, &spectrumCapture, &sharedSpectrum);
+
+    if (juce::SystemStats::getEnvironmentVariable("PFM_PUBLISH_SPECTRA", {}).isNotEmpty())
+        startSharedPublishing();
 }
 
 PFMProject0AudioProcessor::~PFMProject0AudioProcessor()
@@ -476,8 +279,21 @@ void PFMProject0AudioProcessor::prepareToPlay (double sampleRate, int samplesPer
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-    leftBufferAnalyzer.prepare(sampleRate, samplesPerBlock);
-    rightBufferAnalyzer.prepare(sampleRate, samplesPerBlock);
+    noiseGenerator.prepare(sampleRate, getTotalNumOutputChannels());
+
+    // benchmark every order's backends now, so switching FFT size later never stalls the message thread;
+    // after the first prepareToPlay in the process this only looks the choices up
+    for (auto order = FFTPipeline::minOrder; order <= FFTPipeline::maxOrder; ++order)
+        FFTBackend::benchmark(order);
+
+    applyAnalysisParameters();
+    leftAnalysisEngine.prepare(sampleRate, samplesPerBlock);
+    rightAnalysisEngine.prepare(sampleRate, samplesPerBlock);
+
+    // with two channels the left engine's job analyzes both, so the pair's frames stay in step
+    leftAnalysisEngine.setStereoPartner(getTotalNumOutputChannels() == 2 ? &rightAnalysisEngine : nullptr);
+
+    sharedSpectrum.prepare(sampleRate, FFTSizes::numPoints, leftAnalysisEngine.getFrequencyScale());
 }
 
 void PFMProject0AudioProcessor::releaseResources()
@@ -534,30 +350,19 @@ void PFMProject0AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     // Alternatively, you can process the samples with the channels
     // interleaved by keeping the same state.
 
+    noiseGenerator.process(buffer, playSound->get(), (NoiseGenerator::Colour)noiseColour->getIndex());
 
-    for (int i = 0; i < buffer.getNumSamples(); ++i)
-    {
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-        {
-            if (playSound->get())
-            {
-                buffer.setSample(channel, i, r.nextFloat());
-            }
-            else
-            {
-                buffer.setSample(channel, i, 0);
-            }
-        }
-    }
+    applyAnalysisParameters();
 
+    // with nothing attached to either engine these return straight away
     juce::dsp::AudioBlock<float> block(buffer);
     auto left = block.getSingleChannelBlock(0);
-    leftBufferAnalyzer.cloneBuffer(left);
+    leftAnalysisEngine.pushSamples(left);
 
     if (buffer.getNumChannels() == 2)
     {
         auto right = block.getSingleChannelBlock(1);
-        rightBufferAnalyzer.cloneBuffer(right);
+        rightAnalysisEngine.pushSamples(right);
     }
 
     buffer.clear();
@@ -598,6 +403,100 @@ void PFMProject0AudioProcessor::setStateInformation (const void* data, int sizeI
     DBG(apvts.state.toXmlString());
 }
 
+PipelineStats PFMProject0AudioProcessor::getPipelineStats() const
+{
+    // with a stereo pair the left engine's job does the work for both channels
+    const auto& job = leftAnalysisEngine.getJob();
+
+    PipelineStats stats;
+    stats.leftSamples = leftAnalysisEngine.getSampleStats();
+    stats.rightSamples = rightAnalysisEngine.getSampleStats();
+    stats.leftCurves = leftAnalysisEngine.getCurveStats();
+    stats.rightCurves = rightAnalysisEngine.getCurveStats();
+    stats.blockStamps = leftAnalysisEngine.getBlockStampStats();
+    stats.stereoSpectra = job.getStereoSpectraStats();
+    stats.workerPool = job.getPoolStats();
+    stats.framesAnalysed = job.getNumFramesAnalysed();
+    stats.framesSkipped = job.getNumFramesSkipped();
+    stats.framesDecimated = job.getNumFramesDecimated();
+    stats.framesCaptured = spectrumCapture.getNumFramesWritten();
+    stats.framesCaptureDropped = spectrumCapture.getNumFramesDropped();
+    return stats;
+}
+
+juce::String PFMProject0AudioProcessor::startSharedPublishing()
+{
+    auto error = sharedSpectrum.open();
+
+    if (error.isNotEmpty())
+        return error;
+
+    if (getSampleRate() > 0.0)
+        sharedSpectrum.prepare(getSampleRate(), FFTSizes::numPoints, leftAnalysisEngine.getFrequencyScale());
+
+    if (! sharedSpectrumAttached)
+        attachToEngines(AnalysisConsumers::sharedMemory);
+
+    sharedSpectrumAttached = true;
+    return {};
+}
+
+juce::String PFMProject0AudioProcessor::startCapture(const juce::File& file, bool memoryMapped)
+{
+    SpectrumCapture::Options options;
+    options.memoryMapped = memoryMapped;
+
+    auto error = spectrumCapture.start(file, getSampleRate(), FFTSizes::numPoints, options);
+    if (error.isNotEmpty())
+        return error;
+
+    if (! captureAttached)
+        attachToEngines(AnalysisConsumers::capture);
+
+    captureAttached = true;
+    return {};
+}
+
+void PFMProject0AudioProcessor::stopCapture()
+{
+    spectrumCapture.stop();
+
+    if (captureAttached)
+        detachFromEngines(AnalysisConsumers::capture);
+
+    captureAttached = false;
+}
+
+void PFMProject0AudioProcessor::applyAnalysisParameters()
+{
+    SpectrumSmoother::Ballistics ballistics;
+    ballistics.attackMs = attackMs->get();
+    ballistics.releaseMs = releaseMs->get();
+    ballistics.peakHoldMs = peakHoldMs->get();
+
+    // only atomic stores unless a value changed; the engines apply changes off the audio thread
+    for (auto* engine : { &leftAnalysisEngine, &rightAnalysisEngine })
+    {
+        engine->setFFTOrder(FFTPipeline::minOrder + fftSizeParam->getIndex());
+        engine->setMultiResolution(multiResolution->get());
+        engine->setOverlap(analysisOverlaps[(size_t)overlapParam->getIndex()]);
+        engine->setFrequencyScale((SpectrumMapper::Scale)frequencyScale->getIndex(), (SpectrumMapper::Aggregation)aggregation->getIndex());
+        engine->setBallistics(ballistics);
+    }
+}
+
+void PFMProject0AudioProcessor::attachToEngines(AnalysisConsumers::Kind kind)
+{
+    leftAnalysisEngine.attach(kind);
+    rightAnalysisEngine.attach(kind);
+}
+
+void PFMProject0AudioProcessor::detachFromEngines(AnalysisConsumers::Kind kind)
+{
+    leftAnalysisEngine.detach(kind);
+    rightAnalysisEngine.detach(kind);
+}
+
 void PFMProject0AudioProcessor::UpdateAutomatableParameter(juce::RangedAudioParameter* param, float value)
 {
     param->beginChangeGesture();
@@ -15,256 +15,51 @@ Should we play a sound
 
 #include <JuceHeader.h>
 #include <array>
+#include "AnalysisEngine.h"
+#include "FrameScheduler.h"
+#include "NoiseGenerator.h"
 //==============================================================================
-template<typename T>
-struct Fifo
-{
-    bool push(const T& itemToAdd)
-    {
-        auto write = fifo.write(1);
-        if (write.blockSize1 >= 1)
-        {
-            buffer[write.startIndex1] = itemToAdd;
-            return true;
-        }
-        return false;
-    }
-    bool pull(T& itemToUpdate)
-    {
-        auto read = fifo.read(1);
-        if (read.blockSize1 >= 1)
-        {
-            itemToUpdate = buffer[read.startIndex1];
-            return true;
-        }
-        return false;
-    }
-private:
-    static constexpr int Capactiy = 5;
-    std::array<T, Capactiy> buffer;
-    juce::AbstractFifo fifo{ Capactiy };
-};
-
-//==============================================================================
-struct VariableSizedBuffer 
-{
-    void prepare(int size)
-    {
-        buffer.setSize(1, size);
-        buffer.clear();
-        prepared = true;
-    }
-    void clone(const juce::dsp::AudioBlock<float>& other);
-    void clone(const juce::AudioBuffer<float>& other);
-    void clone(const VariableSizedBuffer& other);
-
-    juce::AudioBuffer<float>& getBuffer() { return buffer; }
-    size_t getNumSamples() const { return numSamples; }
-private:
-    juce::AudioBuffer<float> buffer; 
-    size_t numSamples{ 0 };
-    bool prepared = false;
-    template<typename BufferType> 
-    void clear(const BufferType& other)
-    {
-        jassert(prepared);
-        jassert(other.getNumSamples() <= buffer.getNumSamples());
-        buffer.clear();
-    }
-
-    void clear(const VariableSizedBuffer& other)
-    {
-        jassert(prepared);
-        jassert(other.buffer.getNumSamples() <= buffer.getNumSamples());
-        buffer.clear();
-    }
-};
-
-struct VariableSizedBufferFifo
-{
-    void prepare(int samplesPerBlock)
-    {
-        for (auto& buffer : buffers)
-            buffer.prepare(samplesPerBlock);
-    }
-
-    template<typename BlockType>
-    bool push(const BlockType& blockToClone)
-    {
-        auto write = fifo.write(1);
-        if (write.blockSize1 >= 1)
-        {
-            auto& buffer = buffers[write.startIndex1];
-            buffer.clone(blockToClone);
-            return true;
-        }
-        return false;
-    }
-    bool pull(VariableSizedBuffer& bufferToFill)
-    {
-        auto read = fifo.read(1);
-        if (read.blockSize1 >= 1)
-        {
-            auto& buffer = buffers[read.startIndex1];
-            bufferToFill.clone(buffer);
-            return true;
-        }
-        return false;
-    }
-private:
-    static constexpr int Capactiy = 5;
-    std::array<VariableSizedBuffer, Capactiy> buffers;
-    juce::AbstractFifo fifo{ Capactiy };
-};
-//============================================================================
-enum FFTSizes
-{
-    fftOrder = 11,
-    fftSize = 1 << fftOrder,
-    numPoints = 512
-};
-//==============================================================================
-struct FFTDataFfio
-{
-    using BufferType = std::array<float, 2 * FFTSizes::fftSize>;
-
-    bool push(const BufferType& bufferToClone)
-    {
-        auto write = fifo.write(1);
-        if (write.blockSize1 >= 1)
-        {
-            buffers[write.startIndex1] = bufferToClone;
-            return true;
-        }
-        return false;
-    }
-    bool pull(BufferType& bufferToFill)
-    {
-        auto read = fifo.read(1);
-        if (read.blockSize1 >= 1)
-        {
-            bufferToFill = buffers[read.startIndex1];
-            return true;
-        }
-        return false;
-    }
-
-private:
-    static constexpr int Capacity = 5;
-    std::array<BufferType, Capacity> buffers;
-    juce::AbstractFifo fifo{ Capacity };
-};
-//==============================================================================
-struct PathFifo
-{
-    bool push(const juce::Path& pathToClone)
-    {
-        auto write = fifo.write(1);
-        if (write.blockSize1 >= 1)
-        {
-            buffers[write.startIndex1] = pathToClone;
-            return true;
-        }
-        return false;
-    }
-    bool pull(juce::Path& pathToFill)
-    {
-        auto read = fifo.read(1);
-        if (read.blockSize1 >= 1)
-        {
-            pathToFill = buffers[read.startIndex1];
-            return true;
-        }
-        return false;
-    }
-
-private:
-    static constexpr int Capacity = 5;
-    std::array<juce::Path, Capacity> buffers;
-    juce::AbstractFifo fifo{ Capacity };
-};
-//==============================================================================
-struct FFTProcessingThread : juce::Thread
-{
-    FFTProcessingThread(FFTDataFfio&, PathFifo&);
-    ~FFTProcessingThread();
-    void run() override;
-
-private:
-    FFTDataFfio::BufferType fftData;
-    FFTDataFfio& fftDataFifo;
-
-    std::array<float, FFTSizes::numPoints> curveData;
-
-    juce::dsp::FFT forwardFFT{ FFTSizes::fftOrder };
-    juce::dsp::WindowingFunction<float> window{ FFTSizes::fftSize, juce::dsp::WindowingFunction<float>::hann };
-
-    PathFifo& pathFifo;
-};
-//==============================================================================
-struct FFTCopyThread : juce::Thread
-{
-
-    FFTCopyThread(VariableSizedBufferFifo& vsb, PathFifo&);
-    ~FFTCopyThread();
-    void run() override;
-    void prepare(int samplesPerBlock);
-private:
-    VariableSizedBufferFifo& vsbFifo;
-    VariableSizedBuffer buffer;
-
-    std::array<float, FFTSizes::fftSize> fifoBuffer;
-    FFTDataFfio::BufferType fftData;
-    int fifoIndex = 0;
-
-    FFTDataFfio fftDataFifo;
-    FFTProcessingThread fftProcessingThread;
-};
-//==============================================================================
-struct BufferAnalyzer : juce::Component, juce::Timer
+/**
+    Draws one engine's newest curve. Registers as the engine's curve consumer
+    only while it's showing, so a closed or hidden analyzer costs the engine
+    nothing, and at the scheduler's frame rate, so the engine never makes more
+    curves than get drawn. It also tells the engine its size, so each curve
+    arrives already stroked into an image and painting is a blit.
+*/
+struct BufferAnalyzer : juce::Component, FrameScheduler::Client
 {
-    BufferAnalyzer() { startTimerHz(20);  }
-    ~BufferAnalyzer() { stopTimer();  }
-    void prepare(double sampleRate, int samplesPerBlock);
-    void cloneBuffer(const juce::dsp::AudioBlock<float>& other);
-    void timerCallback() override;
+    explicit BufferAnalyzer(AnalysisEngine& engine);
+    ~BufferAnalyzer() override;
+    void frameTick() override;
     void paint(juce::Graphics& g) override;
+    void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
+
 private:
-    juce::Path fftCurve;
-    VariableSizedBufferFifo vsbFifo;
-    PathFifo pathFifo;
-    FFTCopyThread fftCopyThread{ vsbFifo, pathFifo };
+    AnalysisEngine& engine;
+    PathPool& pathPool;
+    PathPool::Handle currentPath = PathPool::invalidHandle;
+    juce::SharedResourcePointer<FrameScheduler> scheduler;
+    bool attached = false;
+    double attachedRate = 0.0;   // the curve rate we're registered with the engine at
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BufferAnalyzer)
 };
 //==============================================================================
-struct BufferAnalyzer2 : juce::Thread, juce::Timer, juce::Component
+/** Every queue in one instance's analyzer pipeline, as counted so far. */
+struct PipelineStats
 {
-    BufferAnalyzer2() ;
-    ~BufferAnalyzer2() ;
-    void prepare(double sampleRate, int samplesPerBlock);
-    void cloneBuffer(const juce::dsp::AudioBlock<float>& other);
-    void run() override;
-    void timerCallback() override;
-    void paint(juce::Graphics& g) override;
-private:
-    std::array<juce::AudioBuffer<float>, 2> buffers;
-    juce::Atomic<bool> firstBuffer{ true };
-    std::array<juce::Atomic<size_t>, 2> samplesCopied;
-
-
-    float fifoBuffer [FFTSizes::fftSize];
-    float fftData[2 * FFTSizes::fftSize];
-    int fifoIndex = 0;
-
-    void pushNextSampleIntoFifo(float);
-
-    juce::Atomic<bool> nextFFTBlockReady{ false };
-    float curveData[FFTSizes::numPoints];
-
-    juce::dsp::FFT forwardFFT{ FFTSizes::fftOrder };
-    juce::dsp::WindowingFunction<float> window{ FFTSizes::fftSize, juce::dsp::WindowingFunction<float>::hann};
-
-    void drawNextFrameOfSpectrum();
-    juce::Path fftCurve;
+    QueueStats leftSamples, rightSamples;   // audio thread -> analysis, in samples
+    QueueStats leftCurves, rightCurves;     // analysis -> message thread, in curves
+    QueueStats blockStamps;                 // audio thread -> analysis, latency stamps
+    QueueStats stereoSpectra;               // analysis -> a stereo consumer; only counts while one is attached
+    QueueStats workerPool;                  // job submissions, shared by every instance in the process
+    int64_t framesAnalysed = 0;
+    int64_t framesSkipped = 0;              // hops jumped over to catch up after falling behind
+    int64_t framesDecimated = 0;            // hops stepped over because no consumer would have seen them
+    int64_t framesCaptured = 0;             // written to the capture file
+    int64_t framesCaptureDropped = 0;       // lost because the capture writer had fallen behind
 };
 //==============================================================================
 /**
@@ -311,12 +106,42 @@ public:
 
     juce::AudioParameterBool* playSound = nullptr;
     juce::AudioParameterFloat* bgColor = nullptr;
+    juce::AudioParameterChoice* noiseColour = nullptr;
+    juce::AudioParameterChoice* fftSizeParam = nullptr;   // index 0 is FFTPipeline::minOrder
+    juce::AudioParameterBool* multiResolution = nullptr;
+    juce::AudioParameterChoice* overlapParam = nullptr;   // how much of each analysis window the next one shares
+    juce::AudioParameterChoice* frequencyScale = nullptr; // in SpectrumMapper::Scale order
+    juce::AudioParameterChoice* aggregation = nullptr;    // in SpectrumMapper::Aggregation order
+    juce::AudioParameterFloat* attackMs = nullptr;        // the curve's ballistics
+    juce::AudioParameterFloat* releaseMs = nullptr;
+    juce::AudioParameterFloat* peakHoldMs = nullptr;
 
     static void UpdateAutomatableParameter(juce::RangedAudioParameter*, float value);
-    BufferAnalyzer leftBufferAnalyzer, rightBufferAnalyzer;
+
+    /** Lock-free; poll it from the editor or a test harness. */
+    PipelineStats getPipelineStats() const;
+
+    /** Streams every frame of both channels to file until stopCapture(). Returns an error message, or an empty string. */
+    juce::String startCapture(const juce::File& file, bool memoryMapped = false);
+    void stopCapture();
+
+    /** Publishes the latest spectra and meters in shared memory from now until the processor is destroyed.
+        Also switched on at construction by the PFM_PUBLISH_SPECTRA environment variable. */
+    juce::String startSharedPublishing();
+
+    // declared before the engines, whose jobs write to them until they're destroyed
+    LatencyMonitor latencyMonitor;
+    SpectrumCapture spectrumCapture;
+    SharedSpectrumPublisher sharedSpectrum;
+    AnalysisEngine leftAnalysisEngine, rightAnalysisEngine;
 private:
     juce::AudioProcessorValueTreeState apvts;
-    juce::Random r;
+    NoiseGenerator noiseGenerator;
+    bool captureAttached = false, sharedSpectrumAttached = false;
+
+    void applyAnalysisParameters();
+    void attachToEngines(AnalysisConsumers::Kind kind);
+    void detachFromEngines(AnalysisConsumers::Kind kind);
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PFMProject0AudioProcessor)
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    SampleRing.h
+    Lock-free power-of-two ring of mono samples, written by the audio thread
+    and read in place by an analysis worker.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "Fifo.h"
+
+//==============================================================================
+/**
+    Single-producer / single-consumer sample ring.
+
+    The audio thread write()s whole blocks with at most two memcpys. The reader
+    peek()s at a run of samples as up to two contiguous spans that point into
+    the ring itself, and advance()s past them when it is done. Capacity is a
+    power of two so wrapping is a mask.
+*/
+struct SampleRing
+{
+    struct Span
+    {
+        const float* first = nullptr;
+        int firstSize = 0;
+        const float* second = nullptr;
+        int secondSize = 0;
+    };
+
+    /** Allocates at least minimumCapacity samples and empties the ring. Only call while neither side is running. */
+    void prepare(int minimumCapacity)
+    {
+        capacity = juce::nextPowerOfTwo(juce::jmax(2, minimumCapacity));
+        mask = capacity - 1;
+        samples.allocate((size_t)capacity, true);
+        writeIndex.store(0);
+        readIndex.store(0);
+    }
+
+    int getCapacity() const { return capacity; }
+
+    //==============================================================================
+    /** Audio thread: appends num samples and returns how many fitted. */
+    int write(const float* source, int num)
+    {
+        auto write = writeIndex.load(std::memory_order_relaxed);
+        auto read = readIndex.load(std::memory_order_acquire);
+        auto toWrite = juce::jmin(num, capacity - (int)(write - read));
+
+        auto start = (int)(write & (size_t)mask);
+        auto firstSize = juce::jmin(toWrite, capacity - start);
+
+        juce::FloatVectorOperations::copy(samples.get() + start, source, firstSize);
+        juce::FloatVectorOperations::copy(samples.get(), source + firstSize, toWrite - firstSize);
+
+        writeIndex.store(write + (size_t)toWrite, std::memory_order_release);
+
+        // the reader can only have moved on since we loaded read, so this is an upper bound on the occupancy
+        auto occupancy = (uint64_t)(write - read) + (uint64_t)toWrite;
+        written.store(written.load(std::memory_order_relaxed) + (uint64_t)toWrite, std::memory_order_relaxed);
+        dropped.store(dropped.load(std::memory_order_relaxed) + (uint64_t)(num - toWrite), std::memory_order_relaxed);
+        if (occupancy > peak.load(std::memory_order_relaxed))
+            peak.store(occupancy, std::memory_order_relaxed);
+
+        return toWrite;
+    }
+
+    //==============================================================================
+    int getNumReady() const
+    {
+        return (int)(writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire));
+    }
+
+    /** Reader: the next num samples, in place. Only valid while num <= getNumReady(). */
+    Span peek(int num) const
+    {
+        jassert(num <= getNumReady());
+
+        auto start = (int)(readIndex.load(std::memory_order_relaxed) & (size_t)mask);
+        auto firstSize = juce::jmin(num, capacity - start);
+
+        return { samples.get() + start, firstSize, samples.get(), num - firstSize };
+    }
+    /** Reader: hands num samples back to the writer. */
+    void advance(int num)
+    {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + (size_t)num, std::memory_order_release);
+    }
+
+    /** Reader: records that it was woken without enough samples to work on. */
+    void noteStarved() { starved.store(starved.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+    /** Counted in samples, across prepare() calls. */
+    QueueStats getStats() const
+    {
+        QueueStats stats;
+        stats.pushed = written.load(std::memory_order_relaxed);
+        stats.dropped = dropped.load(std::memory_order_relaxed);
+        stats.peakOccupancy = peak.load(std::memory_order_relaxed);
+        stats.starved = starved.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    /** Samples written / advanced past since prepare(). Each is only exact on its own side. */
+    juce::int64 getWritePosition() const { return (juce::int64)writeIndex.load(std::memory_order_relaxed); }
+    juce::int64 getReadPosition() const { return (juce::int64)readIndex.load(std::memory_order_relaxed); }
+
+private:
+    juce::HeapBlock<float> samples;
+    int capacity = 0, mask = 0;
+
+    // each side's counters share its index's cache line and are only written by that side
+    alignas(64) std::atomic<size_t> writeIndex{ 0 };
+    std::atomic<uint64_t> written{ 0 }, dropped{ 0 }, peak{ 0 };
+    alignas(64) std::atomic<size_t> readIndex{ 0 };
+    std::atomic<uint64_t> starved{ 0 };
+};
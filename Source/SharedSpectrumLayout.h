@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    SharedSpectrumLayout.h
+    The shared-memory segment each analyzer instance publishes its latest
+    spectra and meters in. Plain C++ with no JUCE, so a monitoring process
+    can include it on its own.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+//==============================================================================
+/**
+    One instance's segment, named "/pfm-analyzer-<pid>-<instance>".
+
+    Each channel is its own seqlock, written by exactly one analysis job: the
+    writer makes sequence odd, writes the payload, then makes it even again.
+    A reader copies the payload out and keeps it only if sequence was even
+    and unchanged across the copy; otherwise it tries again. The writer never
+    waits for readers, however many there are or however slow they are.
+
+    The axis, which changes when the processor is prepared again, is a
+    seqlock of its own written from the message thread. Each frame carries
+    the number of points it filled, so a reader never pairs one size with
+    another's data; one that wants the frequencies too reads the axis and
+    checks its numPoints matches the frame's.
+*/
+struct SharedSpectrumLayout
+{
+    static constexpr uint32_t magicValue = 0x50464d48;   // "PFMH"
+    static constexpr uint32_t currentVersion = 2;
+    static constexpr int maxChannels = 2;
+    static constexpr int maxPoints = 512;
+    static constexpr const char* namePrefix = "/pfm-analyzer-";
+
+    struct ChannelPayload
+    {
+        int64_t frameCount = 0;         // frames published on this channel; 0 means nothing yet
+        int64_t ticks = 0;              // high-resolution ticks when the frame was analyzed
+        uint32_t fftSize = 0;
+        uint32_t numPoints = 0;         // how many of levels and peaks this frame filled
+        float peak = 0.0f;              // of the analysis window's samples, linear
+        float rms = 0.0f;
+        float levels[maxPoints];        // smoothed, 0..1 over the analyzer's dB range
+        float peaks[maxPoints];         // peak hold, same scale
+    };
+
+    struct AxisPayload
+    {
+        double sampleRate = 0.0;            // readers only need it for the axis
+        uint32_t numPoints = 0;
+        float pointFrequencies[maxPoints];  // centre of each display point, in Hz
+    };
+
+    template<typename Payload>
+    struct alignas(64) SeqLock
+    {
+        std::atomic<uint32_t> sequence{ 0 };
+        Payload payload;
+
+        /** Writer side; only ever one writer per seqlock. */
+        void write(const Payload& source)
+        {
+            auto s = sequence.load(std::memory_order_relaxed);
+            sequence.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            std::memcpy(&payload, &source, sizeof(payload));
+
+            sequence.store(s + 2, std::memory_order_release);
+        }
+
+        /** Reader side: false if the writer was part way through, in which case just try again. */
+        bool tryRead(Payload& dest) const
+        {
+            auto before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0)
+                return false;
+
+            std::memcpy(&dest, &payload, sizeof(payload));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            return sequence.load(std::memory_order_relaxed) == before;
+        }
+    };
+
+    using Channel = SeqLock<ChannelPayload>;
+    using Axis = SeqLock<AxisPayload>;
+
+    // fixed when the segment is created, before any reader can see it
+    uint32_t magic = magicValue;
+    uint32_t version = currentVersion;
+    uint32_t numChannels = maxChannels;
+    int64_t processId = 0;
+    int64_t ticksPerSecond = 0;
+
+    Axis axis;                          // rewritten on prepare
+    Channel channels[maxChannels];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "the seqlock must be address-free to live in shared memory");
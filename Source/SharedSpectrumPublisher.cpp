@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    SharedSpectrumPublisher.cpp
+
+  ==============================================================================
+*/
+
+#include "SharedSpectrumPublisher.h"
+#include <new>
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <unistd.h>
+ #define PFM_SHARED_MEMORY 1
+#else
+ #define PFM_SHARED_MEMORY 0
+#endif
+
+//==============================================================================
+juce::String SharedSpectrumPublisher::open()
+{
+   #if PFM_SHARED_MEMORY
+    if (isOpen())
+        return {};
+
+    static std::atomic<int> nextInstance{ 0 };
+    name = SharedSpectrumLayout::namePrefix + juce::String((int)getpid()) + "-" + juce::String(nextInstance++);
+
+    // a segment left behind by a crashed process that happened to have our pid is stale
+    shm_unlink(name.toRawUTF8());
+
+    auto fd = shm_open(name.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+        return "couldn't create shared memory " + name;
+
+    void* mapped = MAP_FAILED;
+    if (ftruncate(fd, (off_t)sizeof(SharedSpectrumLayout)) == 0)
+        mapped = mmap(nullptr, sizeof(SharedSpectrumLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    ::close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        shm_unlink(name.toRawUTF8());
+        return "couldn't map shared memory " + name;
+    }
+
+    auto* newLayout = new (mapped) SharedSpectrumLayout();
+    newLayout->processId = (int64_t)getpid();
+    newLayout->ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
+
+    frameCounts.fill(0);
+    layout.store(newLayout, std::memory_order_release);
+    return {};
+   #else
+    return "shared memory publishing isn't available on this platform";
+   #endif
+}
+void SharedSpectrumPublisher::close()
+{
+   #if PFM_SHARED_MEMORY
+    auto* oldLayout = layout.exchange(nullptr);
+    if (oldLayout == nullptr)
+        return;
+
+    oldLayout->~SharedSpectrumLayout();
+    munmap(oldLayout, sizeof(SharedSpectrumLayout));
+    shm_unlink(name.toRawUTF8());
+   #endif
+}
+void SharedSpectrumPublisher::prepare(double sampleRate, int newNumPoints, SpectrumMapper::Scale scale)
+{
+    auto points = juce::jlimit(1, SharedSpectrumLayout::maxPoints, newNumPoints);
+    numPoints.store(points, std::memory_order_relaxed);
+
+    auto* l = layout.load(std::memory_order_acquire);
+    if (l == nullptr)
+        return;
+
+    // the centres don't depend on the FFT size, so any will do
+    SpectrumMapper mapper;
+    mapper.prepare(sampleRate, 1 << 15, points, scale);
+
+    // the axis is its own seqlock, with the message thread its only writer, so the jobs never contend for a channel's
+    SharedSpectrumLayout::AxisPayload axis;
+    axis.sampleRate = sampleRate;
+    axis.numPoints = (uint32_t)points;
+    for (int i = 0; i < points; ++i)
+        axis.pointFrequencies[i] = mapper.getFrequencyForPoint(i);
+
+    l->axis.write(axis);
+}
+void SharedSpectrumPublisher::publish(int channel, int fftSize, const float* levels, const float* peaks, float peak, float rms)
+{
+    auto* l = layout.load(std::memory_order_acquire);
+    if (l == nullptr || channel < 0 || channel >= SharedSpectrumLayout::maxChannels)
+        return;
+
+    SharedSpectrumLayout::ChannelPayload payload;
+    payload.frameCount = ++frameCounts[(size_t)channel];
+    payload.ticks = juce::Time::getHighResolutionTicks();
+    payload.fftSize = (uint32_t)fftSize;
+    payload.peak = peak;
+    payload.rms = rms;
+
+    // the size goes inside the seqlock with the data it describes
+    auto points = numPoints.load(std::memory_order_relaxed);
+    payload.numPoints = (uint32_t)points;
+    std::copy(levels, levels + points, payload.levels);
+    std::copy(peaks, peaks + points, payload.peaks);
+
+    l->channels[channel].write(payload);
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    SharedSpectrumPublisher.h
+    Publishes an instance's latest spectra and meters in a named POSIX
+    shared-memory segment for monitoring processes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "SharedSpectrumLayout.h"
+#include "SpectrumMapper.h"
+
+//==============================================================================
+/**
+    Owns one SharedSpectrumLayout segment for the lifetime of a processor.
+
+    The analysis jobs publish() each frame straight into the segment's
+    per-channel seqlocks, a few kilobytes of copying per frame with no
+    syscalls and no locks, so readers polling at display rates cost the
+    instance nothing. Nothing is rendered and nothing goes over a socket.
+
+    Only available where POSIX shared memory is (Linux and macOS);
+    elsewhere open() returns an error and publish() does nothing.
+*/
+struct SharedSpectrumPublisher
+{
+    SharedSpectrumPublisher() = default;
+    ~SharedSpectrumPublisher() { close(); }
+
+    /** Creates the segment. Call before the analyzers start publishing: the segment isn't unmapped
+        until close(), which mustn't run while a job might be inside publish(). Returns an error
+        message, or an empty string. */
+    juce::String open();
+    void close();
+    bool isOpen() const { return layout.load(std::memory_order_acquire) != nullptr; }
+
+    /** The name a reader passes to shm_open(). */
+    juce::String getName() const { return name; }
+
+    /** Message thread: what the display points mean. */
+    void prepare(double sampleRate, int numPoints, SpectrumMapper::Scale scale);
+
+    /** Analysis job for channel; there must only be one per channel at a time. */
+    void publish(int channel, int fftSize, const float* levels, const float* peaks, float peak, float rms);
+
+private:
+    std::atomic<SharedSpectrumLayout*> layout{ nullptr };
+    juce::String name;
+    std::atomic<int> numPoints{ SharedSpectrumLayout::maxPoints };   // set on the message thread, read by the jobs
+    std::array<int64_t, SharedSpectrumLayout::maxChannels> frameCounts{};
+
+    JUCE_DECLARE_NON_COPYABLE(SharedSpectrumPublisher)
+};
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    SpectrogramView.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrogramView.h"
+#include "AnalysisEngine.h"
+
+//==============================================================================
+SpectrogramView::SpectrogramView(AnalysisEngine& e) :
+    engine(e), history((size_t)historySize * FFTSizes::numPoints, 0)
+{
+    // the curve's gradient, with silence going to black
+    juce::ColourGradient cg;
+    auto colours = { juce::Colours::black, juce::Colours::violet, juce::Colours::blue, juce::Colours::green,
+                     juce::Colours::yellow, juce::Colours::orange, juce::Colours::red, juce::Colours::white };
+
+    int i = 0;
+    for (auto colour : colours)
+        cg.addColour(double(i++) / double(colours.size() - 1), colour);
+
+    for (size_t level = 0; level < colourTable.size(); ++level)
+        colourTable[level] = cg.getColourAtPosition(double(level) / 255.0).getPixelARGB();
+
+    setOpaque(true);
+}
+SpectrogramView::~SpectrogramView()
+{
+    scheduler->remove(*this);
+    if (attached)
+        engine.detach(AnalysisConsumers::spectrogram);
+}
+void SpectrogramView::visibilityChanged()
+{
+    auto showing = isShowing();
+    if (showing == attached)
+        return;
+
+    attached = showing;
+
+    if (showing)
+    {
+        // whatever was left from the last time we were watching is too old to draw
+        auto& columns = engine.getSpectrogramColumns();
+        ColumnPool::Handle h;
+        while (columns.receive(h))
+            columns.recycle(h);
+
+        // every frame is a column, so this consumer takes them all
+        engine.attach(AnalysisConsumers::spectrogram);
+        scheduler->add(*this, *this);
+    }
+    else
+    {
+        engine.detach(AnalysisConsumers::spectrogram);
+        scheduler->remove(*this);
+    }
+}
+void SpectrogramView::parentHierarchyChanged()
+{
+    visibilityChanged();
+}
+void SpectrogramView::frameTick()
+{
+    engine.applyPendingSettings();
+
+    auto before = numColumns;
+    auto& columns = engine.getSpectrogramColumns();
+
+    ColumnPool::Handle h;
+    columns.noteWakeup();
+    while (columns.receive(h))
+    {
+        auto& column = columns.get(h).levels;
+        auto* slot = history.data() + (size_t)(numColumns % historySize) * FFTSizes::numPoints;
+        std::copy(column.begin(), column.end(), slot);
+        columns.recycle(h);
+
+        drawColumn(numColumns++);
+    }
+
+    if (numColumns != before)
+        repaint();
+}
+void SpectrogramView::drawColumn(juce::int64 column)
+{
+    if (! image.isValid())
+        return;
+
+    auto x = (int)(column % image.getWidth());
+    auto* levels = history.data() + (size_t)(column % historySize) * FFTSizes::numPoints;
+
+    juce::Image::BitmapData pixels(image, x, 0, 1, image.getHeight(), juce::Image::BitmapData::writeOnly);
+
+    for (int row = 0; row < pixels.height; ++row)
+        *reinterpret_cast<juce::PixelARGB*>(pixels.getLinePointer(row)) = colourTable[levels[rowToPoint[(size_t)row]]];
+}
+void SpectrogramView::redrawHistory()
+{
+    if (! image.isValid())
+        return;
+
+    for (auto column = juce::jmax((juce::int64)0, numColumns - image.getWidth()); column < numColumns; ++column)
+        drawColumn(column);
+}
+void SpectrogramView::resized()
+{
+    auto width = juce::jmin(getWidth(), historySize);
+    auto height = getHeight();
+
+    if (width <= 0 || height <= 0)
+    {
+        image = {};
+        return;
+    }
+
+    // software so BitmapData writes straight into the pixels rather than a copy
+    image = juce::Image(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+
+    rowToPoint.resize((size_t)height);
+    for (int row = 0; row < height; ++row)
+        rowToPoint[(size_t)row] = FFTSizes::numPoints - 1 - row * FFTSizes::numPoints / height;
+
+    redrawHistory();
+}
+void SpectrogramView::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+
+    if (! image.isValid())
+        return;
+
+    // the next column to be written is the oldest, so everything right of it goes first
+    auto width = image.getWidth();
+    auto height = image.getHeight();
+    auto split = (int)(numColumns % width);
+    auto x = getWidth() - width;
+
+    g.drawImage(image, x, 0, width - split, height, split, 0, width - split, height);
+    if (split > 0)
+        g.drawImage(image, x + width - split, 0, split, height, 0, 0, split, height);
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    SpectrogramView.h
+    Scrolling time-frequency history of one analyzer channel, drawn a pixel
+    column per frame into a persistent image.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FrameScheduler.h"
+#include <array>
+#include <vector>
+
+struct AnalysisEngine;
+
+//==============================================================================
+/**
+    Keeps the last historySize frames as 8-bit levels and paints them through
+    a 256-entry colour table. Each frame that arrives writes exactly one pixel
+    column into the image at a wrapping x position; paint() blits the two
+    halves either side of that position so the newest column is on the right.
+    Nothing is redrawn from the history except after a resize.
+
+    The view is its engine's spectrogram consumer only while it's showing, so
+    columns are only made while someone can see them.
+*/
+struct SpectrogramView : juce::Component, FrameScheduler::Client
+{
+    static constexpr int historySize = 1024;   // frames kept, and the widest the image gets
+
+    explicit SpectrogramView(AnalysisEngine& engine);
+    ~SpectrogramView() override;
+
+    void frameTick() override;
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
+
+private:
+    AnalysisEngine& engine;
+    juce::SharedResourcePointer<FrameScheduler> scheduler;
+    bool attached = false;
+
+    // historySize columns of numPoints levels, oldest overwritten first
+    std::vector<uint8_t> history;
+    juce::int64 numColumns = 0;
+
+    std::array<juce::PixelARGB, 256> colourTable;
+    std::vector<int> rowToPoint;   // image row -> display point, top row the highest frequency
+    juce::Image image;
+
+    void drawColumn(juce::int64 column);
+    void redrawHistory();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrogramView)
+};
@@ -0,0 +1,276 @@
+/*
+  ==============================================================================
+
+    SpectrumCapture.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumCapture.h"
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <unistd.h>
+ #define PFM_CAPTURE_MMAP 1
+#else
+ #define PFM_CAPTURE_MMAP 0
+#endif
+
+//==============================================================================
+namespace
+{
+    /** The stream does the batching: small record writes land in its buffer and go to disk a buffer at a time. */
+    struct BufferedSink : SpectrumCapture::Sink
+    {
+        BufferedSink(const juce::File& file, size_t bufferBytes) :
+            stream(file, bufferBytes)
+        {
+        }
+
+        bool open() { return stream.openedOk() && stream.setPosition(0) && stream.truncate().wasOk(); }
+
+        bool write(const void* data, size_t numBytes) override { return stream.write(data, numBytes); }
+        bool finish() override
+        {
+            stream.flush();
+            return stream.getStatus().wasOk();
+        }
+
+    private:
+        juce::FileOutputStream stream;
+    };
+
+   #if PFM_CAPTURE_MMAP
+    /** Copies straight into a shared mapping of the file, which grows and is remapped a window at a time. */
+    struct MappedSink : SpectrumCapture::Sink
+    {
+        MappedSink(const juce::File& file, size_t requestedWindowBytes)
+        {
+            auto page = (size_t)sysconf(_SC_PAGESIZE);
+            windowBytes = juce::jmax(page, (requestedWindowBytes + page - 1) / page * page);
+            fd = ::open(file.getFullPathName().toRawUTF8(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        }
+
+        ~MappedSink() override
+        {
+            finish();
+        }
+
+        bool open() { return fd >= 0 && mapWindow(0); }
+
+        bool write(const void* data, size_t numBytes) override
+        {
+            auto* source = static_cast<const char*>(data);
+
+            while (numBytes > 0)
+            {
+                if (used == windowBytes && ! mapWindow(windowStart + (off_t)windowBytes))
+                    return false;
+
+                auto toCopy = juce::jmin(numBytes, windowBytes - used);
+                std::memcpy(window + used, source, toCopy);
+                used += toCopy;
+                source += toCopy;
+                numBytes -= toCopy;
+            }
+
+            return true;
+        }
+
+        bool finish() override
+        {
+            if (fd < 0)
+                return true;
+
+            unmap();
+
+            // the last window was only partly filled
+            auto ok = ftruncate(fd, windowStart + (off_t)used) == 0;
+            ok = ::close(fd) == 0 && ok;
+            fd = -1;
+            return ok;
+        }
+
+    private:
+        int fd = -1;
+        size_t windowBytes = 0, used = 0;
+        off_t windowStart = 0;
+        char* window = nullptr;
+
+        bool mapWindow(off_t start)
+        {
+            unmap();
+
+            if (ftruncate(fd, start + (off_t)windowBytes) != 0)
+                return false;
+
+            auto* mapped = mmap(nullptr, windowBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, start);
+            if (mapped == MAP_FAILED)
+                return false;
+
+            window = static_cast<char*>(mapped);
+            windowStart = start;
+            used = 0;
+            return true;
+        }
+
+        void unmap()
+        {
+            if (window == nullptr)
+                return;
+
+            // start the write-back now, so finished windows don't pile up as dirty pages
+            msync(window, used, MS_ASYNC);
+            munmap(window, windowBytes);
+            window = nullptr;
+        }
+    };
+   #endif
+}
+
+//==============================================================================
+SpectrumCapture::SpectrumCapture() : Thread("Spectrum Capture")
+{
+}
+SpectrumCapture::~SpectrumCapture()
+{
+    stop();
+}
+juce::String SpectrumCapture::start(const juce::File& file, double sampleRate, int points, const Options& options)
+{
+    stop();
+
+    if (points <= 0 || points > maxPoints)
+        return "can't capture " + juce::String(points) + " points per frame";
+
+    if (options.memoryMapped)
+    {
+       #if PFM_CAPTURE_MMAP
+        auto mapped = std::make_unique<MappedSink>(file, options.mappedWindowBytes);
+        if (mapped->open())
+            sink = std::move(mapped);
+       #else
+        return "memory-mapped capture isn't available on this platform";
+       #endif
+    }
+    else
+    {
+        auto buffered = std::make_unique<BufferedSink>(file, options.writeBufferBytes);
+        if (buffered->open())
+            sink = std::move(buffered);
+    }
+
+    if (sink == nullptr)
+        return "couldn't create " + file.getFullPathName();
+
+    numPoints = points;
+    levelBytes = getCaptureLevelBytes((uint32_t)numPoints);
+
+    CaptureFileHeader header;
+    header.numPoints = (uint32_t)numPoints;
+    header.frameBytes = (uint32_t)(sizeof(CaptureFrameHeader) + levelBytes);
+    header.sampleRate = sampleRate;
+    header.ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
+    header.startTicks = juce::Time::getHighResolutionTicks();
+
+    if (! sink->write(&header, sizeof(header)))
+    {
+        sink.reset();
+        return "couldn't write to " + file.getFullPathName();
+    }
+
+    // anything pushed after the last stop() belongs to no file
+    QueuedFrame leftover;
+    while (queue.pop(leftover)) {}
+
+    framesWritten = 0;
+    framesDropped = 0;
+    failed = false;
+    capturing = true;
+    startThread();
+
+    return {};
+}
+void SpectrumCapture::stop()
+{
+    if (sink == nullptr)
+        return;
+
+    capturing = false;
+    signalThreadShouldExit();
+    notify();
+    stopThread(-1);
+
+    // the writer has exited, so whatever it hadn't got to yet is ours to write
+    drain();
+    sink->finish();
+    sink.reset();
+}
+void SpectrumCapture::push(int channel, int fftSize, juce::int64 samplePosition, const uint8_t* levels)
+{
+    if (! capturing.load(std::memory_order_acquire))
+        return;
+
+    QueuedFrame frame;
+    frame.header.ticks = juce::Time::getHighResolutionTicks();
+    frame.header.samplePosition = samplePosition;
+    frame.header.fftSize = (uint32_t)fftSize;
+    frame.header.channel = (uint16_t)channel;
+    std::copy(levels, levels + numPoints, frame.levels.begin());
+    std::fill(frame.levels.begin() + numPoints, frame.levels.begin() + (std::ptrdiff_t)levelBytes, uint8_t(0));
+
+    if (! queue.push(frame))
+        framesDropped.fetch_add(1, std::memory_order_relaxed);
+}
+void SpectrumCapture::run()
+{
+    // polled rather than signalled, so pushing never touches a lock
+    while (! threadShouldExit())
+    {
+        wait(writeIntervalMs);
+        drain();
+    }
+}
+void SpectrumCapture::drain()
+{
+    QueuedFrame frame;
+
+    while (queue.pop(frame))
+    {
+        if (failed)
+            continue;
+
+        if (sink->write(&frame.header, sizeof(frame.header)) && sink->write(frame.levels.data(), levelBytes))
+            framesWritten.fetch_add(1, std::memory_order_relaxed);
+        else
+            failed = true;   // e.g. the disk filled up; keep emptying the queue so pushers never notice
+    }
+}
+//==============================================================================
+SpectrumCaptureReader::SpectrumCaptureReader(const juce::File& file) :
+    map(std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly))
+{
+    if (map->getData() == nullptr || map->getSize() < sizeof(CaptureFileHeader))
+        return;
+
+    auto* candidate = static_cast<const CaptureFileHeader*>(map->getData());
+
+    if (std::memcmp(candidate->magic, "PFMS", 4) != 0 || candidate->version != CaptureFileHeader::currentVersion
+        || candidate->frameBytes != sizeof(CaptureFrameHeader) + getCaptureLevelBytes(candidate->numPoints))
+        return;
+
+    header = candidate;
+    numFrames = (juce::int64)((map->getSize() - sizeof(CaptureFileHeader)) / header->frameBytes);
+}
+SpectrumCaptureReader::Frame SpectrumCaptureReader::getFrame(juce::int64 index) const
+{
+    jassert(isValid() && index >= 0 && index < numFrames);
+
+    auto* record = static_cast<const char*>(map->getData()) + sizeof(CaptureFileHeader) + (size_t)index * header->frameBytes;
+    return { reinterpret_cast<const CaptureFrameHeader*>(record), reinterpret_cast<const uint8_t*>(record + sizeof(CaptureFrameHeader)) };
+}
+double SpectrumCaptureReader::getSeconds(const Frame& frame) const
+{
+    return (double)(frame.header->ticks - header->startTicks) / (double)header->ticksPerSecond;
+}
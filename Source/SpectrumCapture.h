@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    SpectrumCapture.h
+    Streams every analyzer frame to a compact binary file from a dedicated
+    writer thread, and reads such files back.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include "Fifo.h"
+
+//==============================================================================
+/**
+    The capture file: one CaptureFileHeader, then fixed-size records of a
+    CaptureFrameHeader followed by numPoints levels quantized to 0..255 and
+    zero padding up to a multiple of 8 bytes, so every record header in a
+    mapped file stays 8-byte aligned; all little-endian. Because every record
+    is the same size, a file cut short by a crash is still readable up to its
+    last whole frame.
+*/
+struct CaptureFileHeader
+{
+    static constexpr uint32_t currentVersion = 2;
+
+    char magic[4] = { 'P', 'F', 'M', 'S' };
+    uint32_t version = currentVersion;
+    uint32_t numPoints = 0;
+    uint32_t frameBytes = 0;        // header plus padded levels, per record
+    double sampleRate = 0.0;
+    int64_t ticksPerSecond = 0;     // of the frames' timestamps
+    int64_t startTicks = 0;         // when the capture started
+};
+
+struct CaptureFrameHeader
+{
+    int64_t ticks = 0;              // high-resolution ticks when the frame was analyzed
+    int64_t samplePosition = 0;     // the frame's first sample, counted since the analyzer was prepared
+    uint32_t fftSize = 0;
+    uint16_t channel = 0;
+    uint16_t reserved = 0;
+};
+
+static_assert(sizeof(CaptureFileHeader) == 40 && sizeof(CaptureFrameHeader) == 24, "capture records must have no padding");
+
+/** The bytes of levels in a record: numPoints rounded up to keep the next header aligned. */
+constexpr size_t getCaptureLevelBytes(uint32_t numPoints) { return ((size_t)numPoints + 7) & ~(size_t)7; }
+
+//==============================================================================
+/**
+    Any analysis worker push()es frames into a bounded lock-free queue; a
+    single writer thread wakes every writeIntervalMs and drains it into the
+    file in large writes, either
+    through a buffered stream or, where POSIX mmap is available, by copying
+    into a memory-mapped window of a file grown a window at a time. Memory
+    use is the queue plus one write buffer or mapped window, however long
+    the capture runs. A frame that finds the queue full is counted as
+    dropped rather than waited for.
+*/
+struct SpectrumCapture : private juce::Thread
+{
+    static constexpr int maxPoints = 512;
+    static constexpr size_t queueSize = 256;
+    static_assert(getCaptureLevelBytes(maxPoints) == maxPoints, "a queued frame must hold a whole padded record");
+
+    struct Options
+    {
+        bool memoryMapped = false;
+        size_t writeBufferBytes = 1 << 20;      // buffered stream
+        size_t mappedWindowBytes = 64 << 20;    // memory-mapped file, rounded to whole pages
+    };
+
+    SpectrumCapture();
+    ~SpectrumCapture() override;
+
+    /** Creates file, replacing whatever is there, and starts the writer. Returns an error message, or an empty string. */
+    juce::String start(const juce::File& file, double sampleRate, int numPoints, const Options& options);
+    /** Writes out everything already pushed and closes the file. Frames pushed from here on are ignored. */
+    void stop();
+    bool isCapturing() const { return capturing.load(std::memory_order_relaxed); }
+
+    /** Any thread, lock-free; does nothing unless capturing. levels holds the numPoints passed to start(). */
+    void push(int channel, int fftSize, juce::int64 samplePosition, const uint8_t* levels);
+
+    juce::int64 getNumFramesWritten() const { return framesWritten.load(std::memory_order_relaxed); }
+    juce::int64 getNumFramesDropped() const { return framesDropped.load(std::memory_order_relaxed); }
+
+    /** Where the writer puts the bytes. */
+    struct Sink
+    {
+        virtual ~Sink() = default;
+        virtual bool write(const void* data, size_t numBytes) = 0;
+        virtual bool finish() = 0;
+    };
+
+private:
+    struct QueuedFrame
+    {
+        CaptureFrameHeader header;
+        std::array<uint8_t, maxPoints> levels;
+    };
+
+    MpmcQueue<QueuedFrame, queueSize> queue;
+    std::unique_ptr<Sink> sink;
+    int numPoints = 0;
+    size_t levelBytes = 0;          // numPoints plus the record's zero padding
+    static constexpr int writeIntervalMs = 20;
+
+    std::atomic<bool> capturing{ false }, failed{ false };
+    std::atomic<juce::int64> framesWritten{ 0 }, framesDropped{ 0 };
+
+    void run() override;
+    void drain();
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrumCapture)
+};
+
+//==============================================================================
+/** Reads a capture file through a read-only memory map, without copying the frames. */
+struct SpectrumCaptureReader
+{
+    struct Frame
+    {
+        const CaptureFrameHeader* header = nullptr;
+        const uint8_t* levels = nullptr;
+
+        /** A level back on the analyzer's 0..1 scale. */
+        float getLevel(int point) const { return (float)levels[point] / 255.0f; }
+    };
+
+    explicit SpectrumCaptureReader(const juce::File& file);
+
+    /** False if the file is missing or isn't a capture this version understands. */
+    bool isValid() const { return header != nullptr; }
+    const CaptureFileHeader& getHeader() const { return *header; }
+
+    juce::int64 getNumFrames() const { return numFrames; }
+    Frame getFrame(juce::int64 index) const;
+
+    /** Seconds from the start of the capture to a frame. */
+    double getSeconds(const Frame& frame) const;
+
+private:
+    std::unique_ptr<juce::MemoryMappedFile> map;
+    const CaptureFileHeader* header = nullptr;
+    juce::int64 numFrames = 0;
+};
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    SpectrumMapper.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumMapper.h"
+
+//==============================================================================
+float SpectrumMapper::frequencyToScale(float frequency, Scale s)
+{
+    switch (s)
+    {
+        case Scale::mel:  return 2595.0f * std::log10(1.0f + frequency / 700.0f);
+        case Scale::bark: return 26.81f * frequency / (1960.0f + frequency) - 0.53f;   // Traunmueller
+        case Scale::logarithmic:
+        default:          return std::log(frequency);
+    }
+}
+
+float SpectrumMapper::scaleToFrequency(float value, Scale s)
+{
+    switch (s)
+    {
+        case Scale::mel:  return 700.0f * (std::pow(10.0f, value / 2595.0f) - 1.0f);
+        case Scale::bark: return 1960.0f * (value + 0.53f) / (26.28f - value);
+        case Scale::logarithmic:
+        default:          return std::exp(value);
+    }
+}
+
+//==============================================================================
+void SpectrumMapper::prepare(double sampleRate, int fftSize, int numPoints,
+                             Scale newScale, Aggregation newAggregation,
+                             float minFrequency, float maxFrequency)
+{
+    jassert(sampleRate > 0.0 && fftSize > 1 && numPoints > 0);
+
+    scale = newScale;
+    aggregation = newAggregation;
+    numFFTBins = fftSize / 2 + 1;
+
+    points.resize((size_t)numPoints);
+    centreFrequencies.resize((size_t)numPoints);
+    prefixSums.resize((size_t)numFFTBins + 1);
+
+    auto nyquist = (float)sampleRate * 0.5f;
+    maxFrequency = juce::jlimit(minFrequency + 1.0f, nyquist, maxFrequency);
+
+    auto binsPerHz = (float)fftSize / (float)sampleRate;
+    auto scaleMin = frequencyToScale(minFrequency, scale);
+    auto scaleMax = frequencyToScale(maxFrequency, scale);
+
+    auto edgeToBin = [&](int edge)
+    {
+        auto value = juce::jmap((float)edge, 0.0f, (float)numPoints, scaleMin, scaleMax);
+        return scaleToFrequency(value, scale) * binsPerHz;
+    };
+
+    auto lowEdge = edgeToBin(0);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        auto highEdge = edgeToBin(i + 1);
+        auto& point = points[(size_t)i];
+
+        // the whole bins whose centres fall inside [lowEdge, highEdge)
+        auto firstBin = (int)std::ceil(lowEdge);
+        auto lastBin = juce::jmin(numFFTBins, (int)std::ceil(highEdge));
+
+        if (lastBin - firstBin >= 2)
+        {
+            point.firstBin = firstBin;
+            point.numBins = lastBin - firstBin;
+            point.inverseNumBins = 1.0f / (float)point.numBins;
+        }
+        else
+        {
+            auto centre = juce::jlimit(0.0f, (float)(numFFTBins - 2), 0.5f * (lowEdge + highEdge));
+            point.firstBin = (int)centre;
+            point.numBins = 0;
+            point.fraction = centre - (float)point.firstBin;
+        }
+
+        centreFrequencies[(size_t)i] = 0.5f * (lowEdge + highEdge) / binsPerHz;
+        lowEdge = highEdge;
+    }
+}
+
+void SpectrumMapper::process(const float* magnitudes, float* output)
+{
+    jassert(! points.empty());
+
+    if (aggregation == Aggregation::mean)
+    {
+        // one running sum turns every mean into a subtraction
+        auto sum = 0.0f;
+        prefixSums[0] = 0.0f;
+
+        for (int b = 0; b < numFFTBins; ++b)
+        {
+            sum += magnitudes[b];
+            prefixSums[(size_t)b + 1] = sum;
+        }
+    }
+
+    auto numPoints = (int)points.size();
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const auto& point = points[(size_t)i];
+
+        if (point.numBins == 0)
+        {
+            auto lower = magnitudes[point.firstBin];
+            output[i] = lower + point.fraction * (magnitudes[point.firstBin + 1] - lower);
+        }
+        else if (aggregation == Aggregation::max)
+        {
+            output[i] = juce::FloatVectorOperations::findMaximum(magnitudes + point.firstBin, point.numBins);
+        }
+        else
+        {
+            auto total = prefixSums[(size_t)(point.firstBin + point.numBins)] - prefixSums[(size_t)point.firstBin];
+            output[i] = total * point.inverseNumBins;
+        }
+    }
+}
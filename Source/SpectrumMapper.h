@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    SpectrumMapper.h
+    Maps FFT bins onto display points along a perceptual frequency axis.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+    Precomputed bin-to-point mapping.
+
+    prepare() works out, once, which FFT bins each display point covers on a
+    log, mel or Bark frequency axis. Points spanning several bins reduce them
+    with max or mean (no aliasing at the top end); points narrower than a bin
+    interpolate between the two nearest bins (no staircase at the bottom end).
+    process() is then a table-driven gather and reduce with no transcendental
+    calls, so it costs about one pass over the magnitudes per frame.
+*/
+struct SpectrumMapper
+{
+    enum class Scale
+    {
+        logarithmic,
+        mel,
+        bark
+    };
+
+    enum class Aggregation
+    {
+        max,
+        mean
+    };
+
+    /** Rebuilds the tables. Not realtime safe; don't call while process() may run. */
+    void prepare(double sampleRate, int fftSize, int numPoints,
+                 Scale scale = Scale::logarithmic, Aggregation aggregation = Aggregation::max,
+                 float minFrequency = 20.0f, float maxFrequency = 20000.0f);
+
+    /** magnitudes holds fftSize / 2 + 1 bins, output receives numPoints values. */
+    void process(const float* magnitudes, float* output);
+
+    int getNumPoints() const { return (int)points.size(); }
+    Scale getScale() const { return scale; }
+    Aggregation getAggregation() const { return aggregation; }
+
+    /** The frequency at the centre of a display point, e.g. for drawing a grid. */
+    float getFrequencyForPoint(int point) const { return centreFrequencies[(size_t)point]; }
+
+    static float frequencyToScale(float frequency, Scale scale);
+    static float scaleToFrequency(float value, Scale scale);
+
+private:
+    struct Point
+    {
+        int firstBin = 0;
+        int numBins = 0;          // 0 means interpolate between firstBin and firstBin + 1
+        float fraction = 0.0f;    // interpolation weight of firstBin + 1
+        float inverseNumBins = 0.0f;
+    };
+
+    std::vector<Point> points;
+    std::vector<float> centreFrequencies;
+    std::vector<float> prefixSums;
+    int numFFTBins = 0;
+    Scale scale = Scale::logarithmic;
+    Aggregation aggregation = Aggregation::max;
+};
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    SpectrumSmoother.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumSmoother.h"
+
+namespace
+{
+    // Mineiro's fastlog2: the exponent comes straight from the float's bits and a
+    // rational fit covers the mantissa. No branches and no library calls, so the
+    // loop below vectorizes.
+    inline float fastLog2(float x)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+
+        uint32_t mantissaBits = (bits & 0x007fffffu) | 0x3f000000u;
+        float mantissa;
+        std::memcpy(&mantissa, &mantissaBits, sizeof(mantissa));
+
+        auto y = (float)bits * 1.1920928955078125e-7f;
+        return y - 124.22551499f - 1.498030302f * mantissa - 1.72587999f / (0.3520887068f + mantissa);
+    }
+
+    constexpr float decibelsPerOctave = 6.0205999f;  // 20 * log10(2)
+
+    inline juce::dsp::SIMDRegister<float> select(juce::dsp::SIMDRegister<float>::vMaskType mask,
+                                                 juce::dsp::SIMDRegister<float> whenTrue,
+                                                 juce::dsp::SIMDRegister<float> whenFalse)
+    {
+        return (whenTrue & mask) + (whenFalse & ~mask);
+    }
+}
+
+//==============================================================================
+void SpectrumSmoother::prepare(int points, float newMindB, float newMaxdB)
+{
+    jassert(newMaxdB > newMindB);
+
+    numPoints = points;
+    mindB = newMindB;
+    maxdB = newMaxdB;
+
+    auto numRegisters = (size_t)(points + (int)Register::SIMDNumElements - 1) / Register::SIMDNumElements;
+
+    decibels.resize(numRegisters);
+    levels.resize(numRegisters);
+    peaks.resize(numRegisters);
+    holdCounters.resize(numRegisters);
+
+    reset();
+}
+
+void SpectrumSmoother::reset()
+{
+    auto silence = Register::expand(mindB);
+    auto zero = Register::expand(0.0f);
+
+    // the padding lanes read as silence, so they never disturb the real ones
+    std::fill(decibels.begin(), decibels.end(), silence);
+    std::fill(levels.begin(), levels.end(), zero);
+    std::fill(peaks.begin(), peaks.end(), zero);
+    std::fill(holdCounters.begin(), holdCounters.end(), zero);
+}
+
+void SpectrumSmoother::setFrameRate(double framesPerSecond, const Ballistics& ballistics)
+{
+    jassert(framesPerSecond > 0.0);
+
+    auto coefficientFor = [framesPerSecond](float ms)
+    {
+        auto frames = (double)ms * 0.001 * framesPerSecond;
+        return frames > 0.0 ? (float)(1.0 - std::exp(-1.0 / frames)) : 1.0f;
+    };
+
+    attackCoefficient = coefficientFor(ballistics.attackMs);
+    releaseCoefficient = coefficientFor(ballistics.releaseMs);
+    peakHoldFrames = (float)(ballistics.peakHoldMs * 0.001 * framesPerSecond);
+    peakDecayPerFrame = (float)(ballistics.peakDecayDbPerSecond / framesPerSecond) / (maxdB - mindB);
+}
+
+void SpectrumSmoother::process(const float* magnitudes, float referenceGain)
+{
+    jassert(numPoints > 0);
+
+    // magnitude -> dB relative to the reference
+    auto offset = -decibelsPerOctave * fastLog2(referenceGain);
+    auto* dB = reinterpret_cast<float*>(decibels.data());
+
+    for (int i = 0; i < numPoints; ++i)
+        dB[i] = decibelsPerOctave * fastLog2(juce::jmax(magnitudes[i], 1.0e-9f)) + offset;
+
+    // clamp, normalize and apply the ballistics a whole register at a time
+    auto lowest = Register::expand(mindB);
+    auto highest = Register::expand(maxdB);
+    auto inverseRange = Register::expand(1.0f / (maxdB - mindB));
+    auto attack = Register::expand(attackCoefficient);
+    auto release = Register::expand(releaseCoefficient);
+    auto holdFrames = Register::expand(peakHoldFrames);
+    auto decay = Register::expand(peakDecayPerFrame);
+    auto zero = Register::expand(0.0f);
+    auto one = Register::expand(1.0f);
+
+    for (size_t r = 0; r < decibels.size(); ++r)
+    {
+        auto level = (Register::min(Register::max(decibels[r], lowest), highest) - lowest) * inverseRange;
+
+        auto coefficient = select(Register::greaterThan(level, levels[r]), attack, release);
+        levels[r] = levels[r] + coefficient * (level - levels[r]);
+
+        auto newPeak = Register::greaterThanOrEqual(level, peaks[r]);
+        auto holding = Register::greaterThan(holdCounters[r], zero);
+        auto decayed = Register::max(peaks[r] - decay, level);
+
+        peaks[r] = select(newPeak, level, select(holding, peaks[r], decayed));
+        holdCounters[r] = select(newPeak, holdFrames, Register::max(holdCounters[r] - one, zero));
+    }
+}
+
+void SpectrumSmoother::getQuantizedLevels(uint8_t* dest) const
+{
+    // levels are already clamped to 0..1
+    auto* source = getLevels();
+
+    for (int i = 0; i < numPoints; ++i)
+        dest[i] = (uint8_t)(source[i] * 255.0f + 0.5f);
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    SpectrumSmoother.h
+    Vectorized post-FFT stage: magnitude to dB, normalization, attack/release
+    smoothing and peak hold.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+    Turns one frame of per-point magnitudes into smoothed, normalized 0..1 levels
+    and decaying peak-hold levels.
+
+    The dB conversion is a branch-free log2 approximation (about 0.001 dB error)
+    written as plain scalar code for the compiler to vectorize: it works on the
+    float's bits, and SIMDRegister has neither the integer shifts nor the
+    int-to-float conversion that needs. Clamping, normalization and the
+    ballistics run on juce::dsp::SIMDRegister, so SSE on x86 and NEON on ARM.
+    All state lives in preallocated, register-aligned arrays, padded up to a
+    whole number of registers.
+*/
+struct SpectrumSmoother
+{
+    struct Ballistics
+    {
+        float attackMs = 20.0f;
+        float releaseMs = 250.0f;
+        float peakHoldMs = 500.0f;
+        float peakDecayDbPerSecond = 20.0f;
+
+        bool operator!=(const Ballistics& other) const
+        {
+            return attackMs != other.attackMs || releaseMs != other.releaseMs
+                || peakHoldMs != other.peakHoldMs || peakDecayDbPerSecond != other.peakDecayDbPerSecond;
+        }
+    };
+
+    /** Not realtime safe. */
+    void prepare(int numPoints, float mindB = -100.0f, float maxdB = 0.0f);
+    /** Coefficients depend on how often process() is called; cheap to call whenever that changes. */
+    void setFrameRate(double framesPerSecond, const Ballistics& ballistics);
+    void reset();
+
+    /** magnitudes holds numPoints linear magnitudes; they are scaled by 1 / referenceGain first. */
+    void process(const float* magnitudes, float referenceGain);
+
+    const float* getLevels() const { return reinterpret_cast<const float*>(levels.data()); }
+    const float* getPeaks() const { return reinterpret_cast<const float*>(peaks.data()); }
+    /** The levels rounded to 0..255, for keeping long histories compact. */
+    void getQuantizedLevels(uint8_t* dest) const;
+    int getNumPoints() const { return numPoints; }
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    int numPoints = 0;
+    float mindB = -100.0f, maxdB = 0.0f;
+
+    float attackCoefficient = 1.0f, releaseCoefficient = 1.0f;
+    float peakHoldFrames = 0.0f, peakDecayPerFrame = 0.0f;
+
+    std::vector<Register> decibels, levels, peaks, holdCounters;
+};
@@ -0,0 +1,534 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Headless micro-benchmarks for each stage of the analyzer pipeline.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/SampleRing.h"
+#include "../../../Source/SpectrumMapper.h"
+#include "../../../Source/SpectrumSmoother.h"
+#include "../../../Source/NoiseGenerator.h"
+#include "../../../Source/FFTBackend.h"
+#include "../../../Source/FFTPipeline.h"
+#include "../../../Source/CurveRenderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <tuple>
+#include <vector>
+
+#if JUCE_LINUX
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+//==============================================================================
+// every allocation in the process goes through here, so a stage that allocates per frame shows up
+namespace
+{
+    std::atomic<int64_t> allocationCount { 0 };
+
+    void* countedAllocation(size_t size)
+    {
+        ++allocationCount;
+
+        if (auto* p = std::malloc(size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    void* countedAlignedAllocation(size_t size, std::align_val_t alignment)
+    {
+        ++allocationCount;
+
+        auto align = juce::jmax(sizeof(void*), (size_t)alignment);
+        auto rounded = (juce::jmax((size_t)1, size) + align - 1) & ~(align - 1);
+
+        if (auto* p = std::aligned_alloc(align, rounded))
+            return p;
+
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(size_t size)                                 { return countedAllocation(size); }
+void* operator new[](size_t size)                               { return countedAllocation(size); }
+void* operator new(size_t size, std::align_val_t alignment)     { return countedAlignedAllocation(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment)   { return countedAlignedAllocation(size, alignment); }
+void operator delete(void* p) noexcept                          { std::free(p); }
+void operator delete[](void* p) noexcept                        { std::free(p); }
+void operator delete(void* p, size_t) noexcept                  { std::free(p); }
+void operator delete[](void* p, size_t) noexcept                { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept        { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept      { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept    { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept  { std::free(p); }
+
+//==============================================================================
+/** Hardware cache-miss counter for this thread, where the kernel lets us have one. */
+struct CacheMissCounter
+{
+    CacheMissCounter()
+    {
+       #if JUCE_LINUX
+        perf_event_attr attributes {};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        fd = (int)syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+       #endif
+    }
+
+    ~CacheMissCounter()
+    {
+       #if JUCE_LINUX
+        if (fd >= 0)
+            close(fd);
+       #endif
+    }
+
+    bool isAvailable() const { return fd >= 0; }
+
+    void start()
+    {
+       #if JUCE_LINUX
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+       #endif
+    }
+
+    int64_t stop()
+    {
+        long long count = 0;
+
+       #if JUCE_LINUX
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            if (read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count))
+                count = 0;
+        }
+       #endif
+
+        return (int64_t)count;
+    }
+
+private:
+    int fd = -1;
+};
+
+//==============================================================================
+/**
+    Times one stage over one grid point.
+
+    A "frame" is one call of the stage: an audio block for the audio-thread
+    stages, an FFT frame for the analysis stages. nsPerSample divides by the
+    samples (or display points) that frame consumes, so stages with different
+    frame sizes can be compared.
+*/
+struct Benchmark
+{
+    Benchmark(double secondsPerCase, const juce::String& filter) :
+        batchSeconds(secondsPerCase / numBatches), stageFilter(filter)
+    {
+    }
+
+    template<typename FrameFunction>
+    void run(const juce::String& stage, int fftOrder, int blockSize, int channels, int samplesPerFrame, FrameFunction&& frame)
+    {
+        if (stageFilter.isNotEmpty() && ! stage.matchesWildcard(stageFilter, true))
+            return;
+
+        // warm the caches and anything the stage sizes lazily
+        for (int i = 0; i < 16; ++i)
+            frame();
+
+        int64_t framesPerBatch = 1;
+        while (timeFrames(framesPerBatch, frame) < batchSeconds && framesPerBatch < (1 << 24))
+            framesPerBatch *= 2;
+
+        std::vector<double> nsPerFrame;
+        nsPerFrame.reserve(numBatches);
+
+        auto allocationsBefore = allocationCount.load();
+        cacheMisses.start();
+
+        for (int b = 0; b < numBatches; ++b)
+            nsPerFrame.push_back(timeFrames(framesPerBatch, frame) * 1.0e9 / (double)framesPerBatch);
+
+        auto misses = cacheMisses.stop();
+        auto allocations = allocationCount.load() - allocationsBefore;
+
+        std::sort(nsPerFrame.begin(), nsPerFrame.end());
+        auto median = nsPerFrame[nsPerFrame.size() / 2];
+        auto totalFrames = (double)(framesPerBatch * numBatches);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("stage", stage);
+        result->setProperty("fftOrder", fftOrder);
+        result->setProperty("blockSize", blockSize);
+        result->setProperty("channels", channels);
+        result->setProperty("samplesPerFrame", samplesPerFrame);
+        result->setProperty("frames", totalFrames);
+        result->setProperty("nsPerFrame", median);
+        result->setProperty("nsPerFrameMin", nsPerFrame.front());
+        result->setProperty("nsPerFrameMax", nsPerFrame.back());
+        result->setProperty("nsPerSample", median / (double)samplesPerFrame);
+        result->setProperty("allocationsPerFrame", (double)allocations / totalFrames);
+        result->setProperty("cacheMissesPerFrame", cacheMisses.isAvailable() ? juce::var((double)misses / totalFrames) : juce::var());
+
+        results.add(juce::var(result));
+
+        std::cerr << stage << " order=" << fftOrder << " block=" << blockSize << " channels=" << channels
+                  << ": " << juce::String(median, 1) << " ns/frame" << std::endl;
+    }
+
+    juce::var toJSON(const juce::NamedValueSet& header) const
+    {
+        auto* root = new juce::DynamicObject();
+
+        for (const auto& property : header)
+            root->setProperty(property.name, property.value);
+
+        root->setProperty("cacheMissesAvailable", cacheMisses.isAvailable());
+        root->setProperty("results", results);
+
+        return juce::var(root);
+    }
+
+private:
+    static constexpr int numBatches = 7;
+
+    double batchSeconds;
+    juce::String stageFilter;
+    CacheMissCounter cacheMisses;
+    juce::Array<juce::var> results;
+
+    template<typename FrameFunction>
+    static double timeFrames(int64_t numFrames, FrameFunction& frame)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (int64_t i = 0; i < numFrames; ++i)
+            frame();
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+//==============================================================================
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numPoints = 512;
+
+    // keeps the optimizer from discarding a stage's output
+    volatile float sink = 0.0f;
+
+    std::vector<float> makeNoise(int numSamples)
+    {
+        juce::Random random(1234);
+        std::vector<float> samples((size_t)numSamples);
+
+        for (auto& s : samples)
+            s = random.nextFloat() * 2.0f - 1.0f;
+
+        return samples;
+    }
+
+    /** Feeds rings a hop at a time, like the audio thread does, so a pipeline that keeps state
+        across frames (the multi-resolution bands) sees new samples on every call. */
+    struct SteadyInput
+    {
+        SteadyInput(int channels, int fftSize, int hopSize) :
+            rings((size_t)channels), noise(makeNoise(8 * fftSize)), size(fftSize), hop(hopSize)
+        {
+            for (auto& ring : rings)
+            {
+                ring.prepare(8 * fftSize);
+                ring.write(noise.data(), fftSize);
+            }
+        }
+
+        /** Moves every ring on by a hop, wrapping through the noise. */
+        void step()
+        {
+            for (auto& ring : rings)
+            {
+                ring.advance(hop);
+                ring.write(noise.data() + position, hop);
+            }
+
+            position = (position + hop) % ((int)noise.size() - hop);
+        }
+
+        std::vector<SampleRing> rings;
+        std::vector<float> noise;
+        int size, hop, position = 0;
+    };
+
+    //==============================================================================
+    void benchmarkAudioThreadStages(Benchmark& benchmark, const std::vector<int>& blockSizes, const std::vector<int>& channelCounts)
+    {
+        for (auto channels : channelCounts)
+        {
+            for (auto blockSize : blockSizes)
+            {
+                auto input = makeNoise(blockSize);
+                std::vector<SampleRing> rings((size_t)channels);
+
+                for (auto& ring : rings)
+                    ring.prepare(juce::jmax(8 << 11, 4 * blockSize));
+
+                // write a block into every channel's ring, with the reader keeping up
+                benchmark.run("ringWrite", 0, blockSize, channels, blockSize * channels, [&]
+                {
+                    for (auto& ring : rings)
+                    {
+                        ring.write(input.data(), blockSize);
+                        ring.advance(blockSize);
+                    }
+                });
+
+                juce::AudioBuffer<float> buffer(channels, blockSize);
+                NoiseGenerator noise;
+                noise.prepare(sampleRate, channels);
+
+                const std::pair<const char*, NoiseGenerator::Colour> colours[] = {
+                    { "noise.white", NoiseGenerator::Colour::white },
+                    { "noise.pink", NoiseGenerator::Colour::pink },
+                    { "noise.brown", NoiseGenerator::Colour::brown }
+                };
+
+                for (const auto& colour : colours)
+                {
+                    benchmark.run(colour.first, 0, blockSize, channels, blockSize * channels, [&]
+                    {
+                        noise.process(buffer, true, colour.second);
+                        sink = buffer.getSample(0, 0);
+                    });
+                }
+            }
+        }
+    }
+
+    void benchmarkAnalysisStages(Benchmark& benchmark, const std::vector<int>& fftOrders, const std::vector<int>& channelCounts)
+    {
+        for (auto fftOrder : fftOrders)
+        {
+            auto fftSize = 1 << fftOrder;
+            auto numBins = fftSize / 2 + 1;
+
+            // the in-place real transforms the analyzer picks between at start-up, on a buffer refilled each frame
+            auto input = makeNoise(fftSize);
+            std::vector<float> buffer((size_t)fftSize);
+
+            for (auto& backend : FFTBackend::createAll(fftOrder))
+            {
+                benchmark.run(juce::String("fft.") + backend->getName(), fftOrder, 0, 1, fftSize, [&]
+                {
+                    juce::FloatVectorOperations::copy(buffer.data(), input.data(), fftSize);
+                    backend->performRealMagnitudes(buffer.data());
+                    sink = buffer[1];
+                });
+            }
+
+            // the analysis job's per-frame work: window straight out of the ring, FFT, magnitudes, and mapping to
+            // display points, through the same pipelines it runs, stepping the rings by the default hop in between
+            for (auto multiResolution : { false, true })
+            {
+                // a decimated band spans 4 times the samples of the one above, so the longest orders have none
+                if (multiResolution && fftOrder + 2 > FFTPipeline::maxOrder)
+                    continue;
+
+                auto pipeline = createFFTPipeline(fftOrder, multiResolution);
+
+                pipeline->prepare(sampleRate, numPoints, SpectrumMapper::Scale::logarithmic, SpectrumMapper::Aggregation::max);
+
+                auto prefix = juce::String(multiResolution ? "pipeline.multiResolution." : "pipeline.");
+                std::vector<float> curve((size_t)numPoints);
+                StereoSpectrum spectrum;
+                spectrum.allocate(numBins);
+
+                for (auto channels : channelCounts)
+                {
+                    SteadyInput steady(channels, fftSize, fftSize / 2);
+
+                    if (channels == 1)
+                    {
+                        benchmark.run(prefix + "mono", fftOrder, 0, channels, fftSize, [&]
+                        {
+                            steady.step();
+                            pipeline->processMono(steady.rings[0]);
+                            pipeline->map(0, curve.data());
+                            sink = curve[1];
+                        });
+
+                        continue;
+                    }
+
+                    // two real FFTs, to magnitudes or, when the extra stereo spectra are wanted, to complex bins
+                    for (auto withSpectrum : { false, true })
+                    {
+                        benchmark.run(prefix + (withSpectrum ? "stereoSpectra" : "stereo"), fftOrder, 0, channels, fftSize * channels, [&]
+                        {
+                            steady.step();
+                            pipeline->processStereo(steady.rings[0], steady.rings[1], withSpectrum ? &spectrum : nullptr);
+                            pipeline->map(0, curve.data());
+                            pipeline->map(1, curve.data());
+                            sink = curve[1];
+                        });
+                    }
+                }
+            }
+
+            auto magnitudes = makeNoise(numBins);
+            for (auto& m : magnitudes)
+                m = std::abs(m) * (float)fftSize;
+
+            std::vector<float> curve((size_t)numPoints);
+
+            const std::pair<const char*, SpectrumMapper::Scale> scales[] = {
+                { "log", SpectrumMapper::Scale::logarithmic },
+                { "mel", SpectrumMapper::Scale::mel },
+                { "bark", SpectrumMapper::Scale::bark }
+            };
+
+            for (const auto& scale : scales)
+            {
+                for (auto aggregation : { SpectrumMapper::Aggregation::max, SpectrumMapper::Aggregation::mean })
+                {
+                    SpectrumMapper mapper;
+                    mapper.prepare(sampleRate, fftSize, numPoints, scale.second, aggregation);
+
+                    auto name = juce::String("map.") + scale.first + (aggregation == SpectrumMapper::Aggregation::max ? ".max" : ".mean");
+
+                    benchmark.run(name, fftOrder, 0, 1, numBins, [&]
+                    {
+                        mapper.process(magnitudes.data(), curve.data());
+                        sink = curve[0];
+                    });
+                }
+            }
+        }
+    }
+
+    void benchmarkDisplayStages(Benchmark& benchmark)
+    {
+        auto curve = makeNoise(numPoints);
+        for (auto& c : curve)
+            c = std::abs(c);
+
+        SpectrumSmoother smoother;
+        smoother.prepare(numPoints);
+        smoother.setFrameRate(sampleRate / 1024.0, {});
+
+        benchmark.run("smooth", 0, 0, 1, numPoints, [&]
+        {
+            smoother.process(curve.data(), 1.0f);
+            sink = smoother.getLevels()[0];
+        });
+
+        // the curve the analysis job publishes: unscaled, a min/max pair per column, or a spline, then stroked
+        CurveRenderer renderer;
+        CurveFrame frame;
+        frame.path.preallocateSpace(6 * numPoints);
+
+        const std::tuple<const char*, int, int> sizes[] = {
+            { "curve.points", 0, 0 },
+            { "curve.columns", 400, 150 },
+            { "curve.spline", 1600, 600 }
+        };
+
+        for (const auto& size : sizes)
+        {
+            auto width = std::get<1>(size), height = std::get<2>(size);
+
+            benchmark.run(std::get<0>(size), 0, 0, 1, numPoints, [&]
+            {
+                renderer.buildPath(frame.path, smoother.getLevels(), smoother.getPeaks(), numPoints, width, height);
+                sink = frame.path.getBounds().getHeight();
+            });
+
+            if (width == 0)
+                continue;
+
+            benchmark.run(juce::String(std::get<0>(size)) + ".rasterize", 0, 0, 1, numPoints, [&]
+            {
+                renderer.rasterize(frame, width, height);
+                sink = (float)frame.image.getWidth();
+            });
+        }
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        std::cout << "AnalyzerBenchmark [--quick] [--seconds <per case>] [--stage <wildcard>] [--output <file.json>]" << std::endl;
+        return 0;
+    }
+
+    auto quick = args.containsOption("--quick");
+    auto secondsOption = args.getValueForOption("--seconds");
+    auto secondsPerCase = secondsOption.isNotEmpty() ? secondsOption.getDoubleValue() : (quick ? 0.05 : 0.25);
+
+    std::vector<int> fftOrders = quick ? std::vector<int> { 9, 11, 13 } : std::vector<int> { 9, 10, 11, 12, 13, 14, 15 };
+    std::vector<int> blockSizes = quick ? std::vector<int> { 64, 512 } : std::vector<int> { 32, 64, 128, 256, 512, 1024, 2048 };
+    std::vector<int> channelCounts { 1, 2 };
+
+    Benchmark benchmark(secondsPerCase, args.getValueForOption("--stage"));
+
+    benchmarkAudioThreadStages(benchmark, blockSizes, channelCounts);
+    benchmarkAnalysisStages(benchmark, fftOrders, channelCounts);
+    benchmarkDisplayStages(benchmark);
+
+    juce::NamedValueSet header;
+    header.set("benchmark", "AnalyzerBenchmark");
+    header.set("sampleRate", sampleRate);
+    header.set("numPoints", numPoints);
+    header.set("secondsPerCase", secondsPerCase);
+    header.set("simdRegisterFloats", (int)juce::dsp::SIMDRegister<float>::SIMDNumElements);
+
+    auto json = juce::JSON::toString(benchmark.toJSON(header));
+    auto outputPath = args.getValueForOption("--output");
+
+    if (outputPath.isEmpty())
+    {
+        std::cout << json << std::endl;
+        return 0;
+    }
+
+    auto outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(outputPath);
+
+    if (! outputFile.replaceWithText(json))
+    {
+        std::cerr << "could not write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,282 @@
+/*
+  ==============================================================================
+
+    AnalysisEngineTests.cpp
+    An engine's job on the real worker pool: idle without consumers, what
+    attaching and detaching start and stop, where it picks up again, and how
+    frames beyond what the consumers take are decimated or averaged.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/AnalysisEngine.h"
+
+#include <functional>
+
+//==============================================================================
+/** Blocks of audio into engines whose jobs run on the shared pool, and waiting for them to catch up. */
+struct EngineTest : juce::UnitTest
+{
+    using juce::UnitTest::UnitTest;
+
+protected:
+    // order 11 at 50% overlap: 2048-sample windows, 1024 apart
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int fftSize = 2048;
+    static constexpr int hop = 1024;
+
+    /** Pushes numSamples of a sine into each engine in turn, a stereo partner after its leader. */
+    void push(std::initializer_list<AnalysisEngine*> engines, int numSamples)
+    {
+        juce::AudioBuffer<float> buffer(1, numSamples);
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample(0, i, 0.5f * std::sin(0.05f * (float)(written + i)));
+
+        written += numSamples;
+
+        juce::dsp::AudioBlock<float> block(buffer);
+        for (auto* engine : engines)
+            engine->pushSamples(block);
+    }
+
+    /** Polls until condition holds, or gives up after a couple of seconds. */
+    static bool waitFor(std::function<bool()> condition)
+    {
+        for (int i = 0; i < 2000; ++i)
+        {
+            if (condition())
+                return true;
+
+            juce::Thread::sleep(1);
+        }
+
+        return condition();
+    }
+
+    /** Frames the job has dealt with one way or another. */
+    static int64_t getNumWindows(const AnalysisEngine& engine)
+    {
+        return engine.getNumFramesAnalysed() + engine.getNumFramesDecimated() + engine.getNumFramesSkipped();
+    }
+
+    /** Waits until engine has dealt with expected windows, then long enough to see it doesn't go on to more. */
+    void expectWindows(const AnalysisEngine& engine, int64_t expected)
+    {
+        waitFor([&] { return getNumWindows(engine) >= expected; });
+        juce::Thread::sleep(20);
+        expectEquals(getNumWindows(engine), expected);
+    }
+
+    static void prepare(AnalysisEngine& engine)
+    {
+        engine.setFFTOrder(11);
+        engine.setOverlap(0.5f);
+        engine.prepare(sampleRate, blockSize);
+    }
+
+    juce::int64 written = 0;
+};
+
+//==============================================================================
+struct AnalysisEngineTests : EngineTest
+{
+    AnalysisEngineTests() : EngineTest("AnalysisEngine", category) {}
+
+    void runTest() override
+    {
+        AnalysisEngine engine;
+        prepare(engine);
+
+        beginTest("without consumers nothing goes into the ring and no frame is analyzed");
+        {
+            for (int block = 0; block < 20; ++block)
+                push({ &engine }, blockSize);
+
+            juce::Thread::sleep(20);
+            expect(! engine.isActive());
+            expectEquals((int)engine.getSampleStats().pushed, 0);
+            expectEquals((int)engine.getNumFramesAnalysed(), 0);
+        }
+
+        beginTest("attaching starts analysis from the next block");
+        {
+            engine.attach(AnalysisConsumers::curve);
+            expect(engine.isActive());
+
+            for (int block = 0; block < fftSize / blockSize; ++block)
+                push({ &engine }, blockSize);
+
+            expectEquals((int)engine.getSampleStats().pushed, fftSize);
+            expectWindows(engine, 1);
+
+            // one more hop is one more frame, leaving half a window in the ring
+            push({ &engine }, hop);
+            expectWindows(engine, 2);
+            expectEquals((int)engine.getNumFramesAnalysed(), 2);
+        }
+
+        beginTest("detaching stops the ring filling");
+        {
+            engine.detach(AnalysisConsumers::curve);
+            expect(! engine.isActive());
+
+            for (int block = 0; block < 8; ++block)
+                push({ &engine }, blockSize);
+
+            juce::Thread::sleep(20);
+            expectEquals((int)engine.getSampleStats().pushed, fftSize + hop);
+            expectEquals((int)engine.getNumFramesAnalysed(), 2);
+        }
+
+        beginTest("attaching again skips what was left over, so the first frame is all new audio");
+        {
+            // the hop left from before would make a second frame straddling the gap
+            engine.attach(AnalysisConsumers::curve);
+            push({ &engine }, fftSize);
+
+            expectWindows(engine, 3);
+            expectEquals((int)engine.getNumFramesAnalysed(), 3);
+            expectEquals((int)engine.getNumFramesSkipped(), 0);
+
+            engine.detach(AnalysisConsumers::curve);
+        }
+
+        beginTest("a stereo partner's consumers keep the pair running on the leader's job");
+        {
+            AnalysisEngine left, right;
+            prepare(left);
+            prepare(right);
+            left.setStereoPartner(&right);
+
+            right.attach(AnalysisConsumers::curve);
+            expect(left.isActive());
+
+            push({ &left, &right }, fftSize);
+            expectWindows(left, 1);
+            expectEquals((int)right.getNumFramesAnalysed(), 0);
+
+            // the partner's own ring is only filled through the leader's decision
+            expectEquals((int)right.getSampleStats().pushed, fftSize);
+
+            right.detach(AnalysisConsumers::curve);
+            expect(! left.isActive());
+
+            push({ &left, &right }, fftSize);
+            juce::Thread::sleep(20);
+            expectEquals((int)right.getSampleStats().pushed, fftSize);
+        }
+    }
+};
+static AnalysisEngineTests analysisEngineTests;
+
+//==============================================================================
+struct DecimationTests : EngineTest
+{
+    DecimationTests() : EngineTest("Decimation", category) {}
+
+    void runTest() override
+    {
+        // at a 1024-sample hop, 48000 / (1024 * 10) puts 4 hops in each frame a 10 fps consumer takes
+        beginTest("skip: a 10 fps consumer gets every 4th hop, and the others aren't transformed");
+        {
+            AnalysisEngine engine;
+            prepare(engine);
+            engine.attach(AnalysisConsumers::curve, 10.0);
+
+            pushWindows({ &engine }, engine, 16);
+            expectEquals((int)engine.getNumFramesAnalysed(), 4);
+            expectEquals((int)engine.getNumFramesDecimated(), 12);
+        }
+
+        beginTest("average: every hop is analyzed and averaged into the frame that's published");
+        {
+            AnalysisEngine engine;
+            prepare(engine);
+            engine.setDecimation(FFTProcessingJob::Decimation::average);
+            engine.attach(AnalysisConsumers::curve, 10.0);
+
+            pushWindows({ &engine }, engine, 16);
+            expectEquals((int)engine.getNumFramesAnalysed(), 16);
+            expectEquals((int)engine.getNumFramesDecimated(), 0);
+        }
+
+        beginTest("the fastest consumer sets the rate");
+        {
+            // 30 fps is more than one frame per 1024-sample hop at 48 kHz can give
+            AnalysisEngine engine;
+            prepare(engine);
+            engine.attach(AnalysisConsumers::curve, 10.0);
+            engine.attach(AnalysisConsumers::spectrogram, 30.0);
+
+            pushWindows({ &engine }, engine, 16);
+            expectEquals((int)engine.getNumFramesAnalysed(), 16);
+            expectEquals((int)engine.getNumFramesDecimated(), 0);
+        }
+
+        beginTest("a consumer without a rate gets every frame");
+        {
+            AnalysisEngine engine;
+            prepare(engine);
+            engine.attach(AnalysisConsumers::curve, 10.0);
+            engine.attach(AnalysisConsumers::capture);
+
+            pushWindows({ &engine }, engine, 16);
+            expectEquals((int)engine.getNumFramesAnalysed(), 16);
+            expectEquals((int)engine.getNumFramesDecimated(), 0);
+
+            // and once it's gone, the others are decimated again
+            engine.detach(AnalysisConsumers::capture);
+            pushWindows({ &engine }, engine, 8);
+            expectEquals((int)engine.getNumFramesAnalysed(), 18);
+            expectEquals((int)engine.getNumFramesDecimated(), 6);
+        }
+
+        beginTest("a job that falls behind jumps to the newest whole hop");
+        {
+            // a 2048 + 20 * 1024 sample block is 20 hops over the four windows' backlog the job lets build up
+            AnalysisEngine engine;
+            prepare(engine);
+            engine.attach(AnalysisConsumers::curve);
+
+            push({ &engine }, fftSize + 20 * hop);
+            expectWindows(engine, 21);
+            expectEquals((int)engine.getNumFramesSkipped(), 20);
+            expectEquals((int)engine.getNumFramesAnalysed(), 1);
+        }
+
+        beginTest("a stereo pair is published at its partner's demand too");
+        {
+            AnalysisEngine left, right;
+            prepare(left);
+            prepare(right);
+            left.setStereoPartner(&right);
+
+            right.attach(AnalysisConsumers::curve, 10.0);
+            pushWindows({ &left, &right }, left, 16);
+            expectEquals((int)left.getNumFramesAnalysed(), 4);
+            expectEquals((int)left.getNumFramesDecimated(), 12);
+
+            right.attach(AnalysisConsumers::capture);
+            pushWindows({ &left, &right }, left, 8);
+            expectEquals((int)left.getNumFramesAnalysed(), 12);
+            expectEquals((int)left.getNumFramesDecimated(), 12);
+        }
+    }
+
+private:
+    /** Feeds numWindows more windows, one hop at a time and waiting for each, so the job never falls behind. */
+    void pushWindows(std::initializer_list<AnalysisEngine*> engines, const AnalysisEngine& leader, int numWindows)
+    {
+        for (int w = 0; w < numWindows; ++w)
+        {
+            auto expected = getNumWindows(leader) + 1;
+            push(engines, expected == 1 ? fftSize : hop);
+            expect(waitFor([&] { return getNumWindows(leader) >= expected; }));
+        }
+
+        expectWindows(leader, getNumWindows(leader));
+    }
+};
+static DecimationTests decimationTests;
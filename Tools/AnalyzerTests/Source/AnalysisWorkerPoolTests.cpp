@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    AnalysisWorkerPoolTests.cpp
+    The shared pool's MpmcQueue at its edges and under contention, and the
+    pool itself: one per process, and a job never queued twice or run on
+    two workers at once.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/AnalysisWorkerPool.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+//==============================================================================
+struct MpmcQueueTests : juce::UnitTest
+{
+    MpmcQueueTests() : juce::UnitTest("MpmcQueue", category) {}
+
+    void runTest() override
+    {
+        beginTest("empty, full and wrap");
+        {
+            MpmcQueue<int, 4> queue;
+            int item = -1;
+            int next = 0, expected = 0;
+
+            expect(! queue.pop(item));
+
+            for (int round = 0; round < 5; ++round)
+            {
+                for (int i = 0; i < 4; ++i)
+                    expect(queue.push(next++));
+
+                expect(! queue.push(next));
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    expect(queue.pop(item));
+                    expectEquals(item, expected++);
+                }
+
+                expect(! queue.pop(item));
+            }
+        }
+
+        beginTest("concurrent producers and consumers");
+        {
+            constexpr int numProducers = 2, numConsumers = 2, itemsPerProducer = 100000;
+
+            MpmcQueue<int, 64> queue;
+            std::vector<std::atomic<int>> seen((size_t)(numProducers * itemsPerProducer));
+            std::atomic<int> numTaken{ 0 };
+            std::vector<std::thread> threads;
+
+            for (int p = 0; p < numProducers; ++p)
+                threads.emplace_back([&queue, p]
+                {
+                    for (int i = 0; i < itemsPerProducer; ++i)
+                        while (! queue.push(p * itemsPerProducer + i))
+                            std::this_thread::yield();
+                });
+
+            for (int c = 0; c < numConsumers; ++c)
+                threads.emplace_back([&]
+                {
+                    while (numTaken.load() < numProducers * itemsPerProducer)
+                    {
+                        int item;
+                        if (queue.pop(item))
+                        {
+                            seen[(size_t)item].fetch_add(1);
+                            numTaken.fetch_add(1);
+                        }
+                        else
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+
+            for (auto& thread : threads)
+                thread.join();
+
+            auto allOnce = std::all_of(seen.begin(), seen.end(), [](const std::atomic<int>& count) { return count.load() == 1; });
+            expect(allOnce, "every item should be popped exactly once");
+        }
+    }
+};
+static MpmcQueueTests mpmcQueueTests;
+
+//==============================================================================
+struct AnalysisWorkerPoolTests : juce::UnitTest
+{
+    AnalysisWorkerPoolTests() : juce::UnitTest("AnalysisWorkerPool", category) {}
+
+    void runTest() override
+    {
+        beginTest("every instance shares one pool");
+        {
+            juce::SharedResourcePointer<AnalysisWorkerPool> a, b;
+            expect(&a.get() == &b.get());
+            expectGreaterThan(a->getNumWorkers(), 0);
+        }
+
+        juce::SharedResourcePointer<AnalysisWorkerPool> pool;
+
+        beginTest("a job submitted while it runs runs once more, and never on two workers at once");
+        {
+            GatedJob job;
+            expect(pool->submit(job, AnalysisJob::Priority::high));
+            expect(waitFor([&] { return job.running.load(); }));
+
+            // the first of these marks it to go again; the rest find it already waiting
+            for (int i = 0; i < 50; ++i)
+                expect(pool->submit(job, AnalysisJob::Priority::high));
+
+            job.open = true;
+            expect(waitFor([&] { return job.runs.load() == 2; }));
+            juce::Thread::sleep(20);
+
+            expectEquals(job.runs.load(), 2);
+            expect(! job.overlapped.load());
+        }
+
+        beginTest("a suspended job is refused until it's resumed");
+        {
+            GatedJob job;
+            job.open = true;
+            job.suspend();
+            expect(! pool->submit(job, AnalysisJob::Priority::normal));
+
+            job.resume();
+            expect(pool->submit(job, AnalysisJob::Priority::normal));
+            expect(waitFor([&] { return job.runs.load() == 1; }));
+        }
+    }
+
+private:
+    /** Holds its first run on a worker until open is set, counting runs and noting any that overlap. */
+    struct GatedJob : AnalysisJob
+    {
+        ~GatedJob() override
+        {
+            open = true;
+            suspend();
+        }
+
+        void runJob() override
+        {
+            if (running.exchange(true))
+                overlapped = true;
+
+            while (! open.load())
+                juce::Thread::sleep(1);
+
+            ++runs;
+            running = false;
+        }
+
+        std::atomic<bool> open{ false }, running{ false }, overlapped{ false };
+        std::atomic<int> runs{ 0 };
+    };
+
+    /** Polls until condition holds, or gives up after a couple of seconds. */
+    static bool waitFor(std::function<bool()> condition)
+    {
+        for (int i = 0; i < 2000 && ! condition(); ++i)
+            juce::Thread::sleep(1);
+
+        return condition();
+    }
+};
+static AnalysisWorkerPoolTests analysisWorkerPoolTests;
@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    AnalyzerTests.h
+    What every test file in this target shares.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/SampleRing.h"
+
+#include <vector>
+
+//==============================================================================
+/** main() runs every juce::UnitTest in this category. */
+static constexpr const char* category = "Analyzer";
+
+/** The largest absolute difference between a and b over num values. */
+inline float getLargestDifference(const float* a, const float* b, int num)
+{
+    auto largest = 0.0f;
+    for (int i = 0; i < num; ++i)
+        largest = juce::jmax(largest, std::abs(a[i] - b[i]));
+
+    return largest;
+}
+
+/** A sine in bin of a size-sample window plus some noise, written into ring. */
+inline void writeSine(SampleRing& ring, int size, int bin, float amplitude, float noise, juce::Random& random)
+{
+    std::vector<float> samples((size_t)size);
+    for (int i = 0; i < size; ++i)
+        samples[(size_t)i] = amplitude * std::sin(juce::MathConstants<float>::twoPi * (float)((bin * i) % size) / (float)size)
+                             + noise * (2.0f * random.nextFloat() - 1.0f);
+
+    ring.write(samples.data(), size);
+}
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    CurveRendererTests.cpp
+    The curve's level of detail at each kind of target size: one vertex a
+    point without one, a min/max pair a column when narrower than the data,
+    just enough chords of a spline when wider.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/CurveRenderer.h"
+
+#include <algorithm>
+#include <vector>
+
+//==============================================================================
+struct CurveRendererTests : juce::UnitTest
+{
+    CurveRendererTests() : juce::UnitTest("CurveRenderer", category) {}
+
+    void runTest() override
+    {
+        CurveRenderer renderer;
+        juce::Path path;
+
+        std::vector<float> levels((size_t)numPoints), peaks((size_t)numPoints, 0.75f);
+        for (int i = 0; i < numPoints; ++i)
+            levels[(size_t)i] = 0.5f + 0.4f * std::sin(0.1f * (float)i);
+
+        beginTest("without a size, one vertex per point, y from 0 at the top to 1");
+        {
+            renderer.buildPath(path, levels.data(), peaks.data(), numPoints, 0, 0);
+
+            expect(getVertexCounts(path) == std::vector<int>{ numPoints, numPoints });
+            auto bounds = path.getBounds();
+            expectEquals(bounds.getRight(), (float)(numPoints - 1));
+            expectGreaterOrEqual(bounds.getY(), 0.0f);
+            expectLessOrEqual(bounds.getBottom(), 1.0f);
+        }
+
+        beginTest("narrower than the data, at most a min/max pair per column, and nothing lost between them");
+        {
+            constexpr int width = 100, height = 50;
+
+            // a one-point spike, which a vertex per column taken at any fixed point would miss
+            auto spiky = levels;
+            spiky[257] = 1.0f;
+
+            renderer.buildPath(path, spiky.data(), peaks.data(), numPoints, width, height);
+
+            auto counts = getVertexCounts(path);
+            expectEquals((int)counts.size(), 2);
+            expectLessOrEqual(counts[0], 2 * width);
+            expectGreaterOrEqual(counts[0], width);
+            expectEquals(counts[1], width);     // the peak trace only needs the max
+
+            auto bounds = path.getBounds();
+            expectEquals(bounds.getY(), 0.0f);
+            expectLessOrEqual(bounds.getRight(), (float)width);
+        }
+
+        beginTest("wider than the data, flat stretches stay one chord a point");
+        {
+            constexpr int width = 2000, height = 300;
+
+            std::vector<float> flat((size_t)numPoints, 0.5f);
+            renderer.buildPath(path, flat.data(), flat.data(), numPoints, width, height);
+
+            // only the end segments, whose outer neighbours are clamped, may bend enough for a second chord
+            for (auto count : getVertexCounts(path))
+                expect(count >= numPoints && count <= numPoints + 2, juce::String(count) + " vertices");
+        }
+
+        beginTest("wider than the data, curves get more chords but never overshoot the view");
+        {
+            constexpr int width = 2000, height = 300;
+
+            // a step from silence to full scale, where the spline would swing past both
+            std::vector<float> step((size_t)numPoints, 0.0f);
+            std::fill(step.begin() + numPoints / 2, step.end(), 1.0f);
+
+            renderer.buildPath(path, step.data(), levels.data(), numPoints, width, height);
+
+            auto counts = getVertexCounts(path);
+            expectEquals((int)counts.size(), 2);
+            expectGreaterThan(counts[0], numPoints + 2);
+            expectLessOrEqual(counts[0], 8 * (numPoints - 1) + 1);
+
+            auto bounds = path.getBounds();
+            expectGreaterOrEqual(bounds.getY(), 0.0f);
+            expectLessOrEqual(bounds.getBottom(), (float)height);
+            expectWithinAbsoluteError(bounds.getRight(), (float)width, 1.0e-3f);
+        }
+
+        beginTest("rasterizing keeps the frame's image while the size stays the same");
+        {
+            CurveFrame frame;
+            renderer.buildPath(frame.path, levels.data(), peaks.data(), numPoints, 200, 100);
+            renderer.rasterize(frame, 200, 100);
+
+            expectEquals(frame.image.getWidth(), 200);
+            expectEquals(frame.image.getHeight(), 100);
+
+            auto* pixels = juce::Image::BitmapData(frame.image, juce::Image::BitmapData::readOnly).data;
+
+            renderer.rasterize(frame, 200, 100);
+            expect(juce::Image::BitmapData(frame.image, juce::Image::BitmapData::readOnly).data == pixels);
+
+            // something was drawn on the peak trace's row
+            auto drawn = false;
+            for (int x = 0; x < 200; ++x)
+                drawn = drawn || frame.image.getPixelAt(x, 25).getAlpha() > 0;
+
+            expect(drawn);
+        }
+    }
+
+private:
+    static constexpr int numPoints = 512;
+
+    /** How many vertices each subpath of path has. */
+    static std::vector<int> getVertexCounts(const juce::Path& path)
+    {
+        std::vector<int> counts;
+        juce::Path::Iterator it(path);
+
+        while (it.next())
+        {
+            if (it.elementType == juce::Path::Iterator::startNewSubPath)
+                counts.push_back(1);
+            else if (it.elementType == juce::Path::Iterator::lineTo && ! counts.empty())
+                ++counts.back();
+        }
+
+        return counts;
+    }
+};
+static CurveRendererTests curveRendererTests;
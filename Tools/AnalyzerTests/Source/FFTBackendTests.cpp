@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    FFTBackendTests.cpp
+    Every FFT backend held to juce::dsp::FFT, for magnitudes and complex bins.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/FFTBackend.h"
+#include "../../../Source/FFTPipeline.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    /** juce::dsp::FFT's magnitudes of size real samples, as the reference every backend is held to. */
+    std::vector<float> referenceMagnitudes(int order, const std::vector<float>& input)
+    {
+        juce::dsp::FFT fft(order);
+        std::vector<float> buffer((size_t)fft.getSize() * 2, 0.0f);
+        std::copy(input.begin(), input.end(), buffer.begin());
+
+        fft.performFrequencyOnlyForwardTransform(buffer.data());
+        buffer.resize((size_t)fft.getSize() / 2 + 1);
+        return buffer;
+    }
+}
+
+//==============================================================================
+struct FFTBackendTests : juce::UnitTest
+{
+    FFTBackendTests() : juce::UnitTest("FFTBackend", category) {}
+
+    void runTest() override
+    {
+        auto& random = getRandom();
+
+        for (auto order : { FFTPipeline::minOrder, 12, FFTPipeline::maxOrder })
+        {
+            auto size = 1 << order;
+            auto numBins = size / 2 + 1;
+            auto tolerance = 1.0e-4f * (float)size;
+
+            beginTest("PortableRealFFT matches juce::dsp::FFT, order " + juce::String(order));
+            {
+                std::vector<float> input((size_t)size);
+                for (auto& sample : input)
+                    sample = 2.0f * random.nextFloat() - 1.0f;
+
+                auto reference = referenceMagnitudes(order, input);
+
+                PortableRealFFT portable(order);
+                auto data = input;
+                portable.performRealMagnitudes(data.data());
+
+                expectLessOrEqual(getLargestDifference(data.data(), reference.data(), numBins), tolerance);
+            }
+
+            beginTest("every backend finds a cosine in its bin, order " + juce::String(order));
+            {
+                auto bin = size / 8 + 3;
+
+                for (auto& backend : FFTBackend::createAll(order))
+                {
+                    std::vector<float> data((size_t)size);
+                    // the phase wraps in integers, since bin * i outgrows a float's mantissa at the larger sizes
+                    for (int i = 0; i < size; ++i)
+                        data[(size_t)i] = std::cos(juce::MathConstants<float>::twoPi * (float)((bin * i) % size) / (float)size);
+
+                    backend->performRealMagnitudes(data.data());
+
+                    expectWithinAbsoluteError(data[(size_t)bin], (float)size * 0.5f, tolerance, backend->getName());
+                    data[(size_t)bin] = 0.0f;
+                    expectLessOrEqual(*std::max_element(data.begin(), data.begin() + numBins), tolerance, backend->getName());
+                }
+            }
+
+            beginTest("every backend's complex bins match juce::dsp::FFT, order " + juce::String(order));
+            {
+                std::vector<float> input((size_t)size);
+                for (auto& sample : input)
+                    sample = 2.0f * random.nextFloat() - 1.0f;
+
+                juce::dsp::FFT fft(order);
+                std::vector<float> reference((size_t)size * 2, 0.0f);
+                std::copy(input.begin(), input.end(), reference.begin());
+                fft.performRealOnlyForwardTransform(reference.data(), true);
+
+                auto magnitudes = referenceMagnitudes(order, input);
+
+                for (auto& backend : FFTBackend::createAll(order))
+                {
+                    auto data = input;
+                    data.resize((size_t)size + 2);
+                    backend->performRealForward(data.data());
+
+                    expectLessOrEqual(getLargestDifference(data.data(), reference.data(), size + 2), tolerance, backend->getName());
+
+                    // and they're the same spectrum performRealMagnitudes gives
+                    for (int k = 0; k < numBins; ++k)
+                        data[(size_t)k] = std::hypot(data[(size_t)(2 * k)], data[(size_t)(2 * k + 1)]);
+
+                    expectLessOrEqual(getLargestDifference(data.data(), magnitudes.data(), numBins), tolerance, backend->getName());
+                }
+            }
+        }
+    }
+};
+static FFTBackendTests fftBackendTests;
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    FrameAveragerTests.cpp
+    FrameAverager, which folds the hops between published frames into them
+    in average decimation: a power mean over the frames actually analyzed,
+    point by point and channel by channel.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/AnalysisEngine.h"
+
+#include <vector>
+
+//==============================================================================
+struct FrameAveragerTests : juce::UnitTest
+{
+    FrameAveragerTests() : juce::UnitTest("FrameAverager", category) {}
+
+    void runTest() override
+    {
+        constexpr auto numPoints = (size_t)FFTSizes::numPoints;
+
+        FrameAverager averager;
+        averager.reset();
+
+        std::vector<float> a(numPoints, 3.0f), b(numPoints, 4.0f), out(numPoints, -1.0f);
+
+        beginTest("nothing added leaves the values alone");
+        {
+            expectEquals(averager.getNumFrames(0), 0);
+            averager.getMean(0, out.data());
+            expectEquals(out[0], -1.0f);
+        }
+
+        beginTest("a lone frame comes back unchanged");
+        {
+            averager.add(0, a.data());
+            averager.getMean(0, out.data());
+            expectWithinAbsoluteError(out[0], 3.0f, 1.0e-6f);
+            expectWithinAbsoluteError(out[numPoints - 1], 3.0f, 1.0e-6f);
+        }
+
+        beginTest("frames average in power, divided by the frames analyzed");
+        {
+            averager.add(0, b.data());
+            expectEquals(averager.getNumFrames(0), 2);
+
+            // sqrt((9 + 16) / 2), not the 3.5 an average of levels would give
+            averager.getMean(0, out.data());
+            expectWithinAbsoluteError(out[0], std::sqrt(12.5f), 1.0e-5f);
+        }
+
+        beginTest("channels are kept apart, and reset starts a new group");
+        {
+            expectEquals(averager.getNumFrames(1), 0);
+            averager.add(1, b.data());
+            averager.getMean(1, out.data());
+            expectWithinAbsoluteError(out[0], 4.0f, 1.0e-6f);
+
+            averager.reset();
+            expectEquals(averager.getNumFrames(0), 0);
+            averager.add(0, b.data());
+            averager.getMean(0, out.data());
+            expectWithinAbsoluteError(out[0], 4.0f, 1.0e-6f);
+        }
+        beginTest("each point is averaged on its own");
+        {
+            // levels rising across the spectrum in one frame and falling in the next
+            for (size_t i = 0; i < numPoints; ++i)
+            {
+                a[i] = (float)i / (float)numPoints;
+                b[i] = 1.0f - a[i];
+            }
+
+            averager.reset();
+            averager.add(0, a.data());
+            averager.add(0, b.data());
+            averager.getMean(0, out.data());
+
+            auto largestError = 0.0f;
+            for (size_t i = 0; i < numPoints; ++i)
+                largestError = juce::jmax(largestError, std::abs(out[i] - std::sqrt(0.5f * (a[i] * a[i] + b[i] * b[i]))));
+
+            expectLessOrEqual(largestError, 1.0e-6f);
+        }
+    }
+};
+static FrameAveragerTests frameAveragerTests;
@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Runs the analyzer's unit tests. Each group of tests lives in its own
+    file and registers itself in the "Analyzer" category.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+
+#include <iostream>
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // an argument runs just the tests whose names contain it, e.g. "FFT"
+    auto filter = argc > 1 ? juce::String(argv[1]) : juce::String();
+
+    juce::Array<juce::UnitTest*> tests;
+    for (auto* test : juce::UnitTest::getTestsInCategory(category))
+        if (filter.isEmpty() || test->getName().containsIgnoreCase(filter))
+            tests.add(test);
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTests(tests);
+
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    std::cout << (failures == 0 ? juce::String("all tests passed") : juce::String(failures) + " failures") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
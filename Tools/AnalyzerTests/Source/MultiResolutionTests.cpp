@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    MultiResolutionTests.cpp
+    The Decimator's passband and stopband, and how MultiResolutionFFTPipeline
+    stitches its bands into one curve.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/MultiResolutionFFTPipeline.h"
+
+#include <algorithm>
+#include <vector>
+
+//==============================================================================
+struct MultiResolutionTests : juce::UnitTest
+{
+    MultiResolutionTests() : juce::UnitTest("MultiResolution", category) {}
+
+    void runTest() override
+    {
+        beginTest("the decimator emits every 4th sample, with unity gain at DC");
+        {
+            Decimator decimator;
+            decimator.reset();
+
+            int numOutputs = 0;
+            float output = 0.0f;
+
+            for (int i = 0; i < 400; ++i)
+                if (decimator.push(1.0f, output))
+                    ++numOutputs;
+
+            expectEquals(numOutputs, 100);
+            expectWithinAbsoluteError(output, 1.0f, 1.0e-4f);
+        }
+
+        beginTest("the bottom half of the output band passes flat");
+        {
+            // 0.05 cycles per input sample is 0.2 of the output rate
+            expectWithinAbsoluteError(getDecimatedPeak(0.05), 1.0f, 0.01f);
+        }
+
+        beginTest("everything above 3/4 of the output rate is at least 70 dB down");
+        {
+            for (auto cyclesPerSample : { 0.19, 0.25, 0.3, 0.45 })
+                expectLessOrEqual(getDecimatedPeak(cyclesPerSample), juce::Decibels::decibelsToGain(-70.0f),
+                                  juce::String(cyclesPerSample) + " cycles per sample");
+        }
+
+        // order 12 with one decimated band at 48 kHz crosses over at 48000 / 16 = 3 kHz
+        using Pipeline = MultiResolutionFFTPipeline<12, 1>;
+
+        beginTest("a tone is drawn at its own point, whichever band draws it");
+        {
+            std::vector<float> curve((size_t)numPoints);
+            std::array<float, 2> levels;
+            auto index = 0;
+
+            for (auto frequency : { 200.0, 8000.0 })
+            {
+                Pipeline pipeline;
+                pipeline.prepare(sampleRate, numPoints, scale, SpectrumMapper::Aggregation::max);
+                runSine(pipeline, frequency, 41, 0);
+                pipeline.map(0, curve.data());
+
+                auto peak = std::max_element(curve.begin(), curve.end());
+                expectWithinAbsoluteError((int)(peak - curve.begin()), getPointFor(frequency), 1, juce::String(frequency) + " Hz");
+                levels[(size_t)index++] = *peak;
+            }
+
+            // both bands run the same size FFT, so the same sine reads about the same, less the Hann window's scalloping
+            expectWithinAbsoluteError(levels[0] / levels[1], 1.0f, 0.2f);
+        }
+
+        beginTest("a tone above the crossover doesn't alias into the decimated band");
+        {
+            // 10 kHz is above 3/4 of the decimated band's 12 kHz rate, and would alias to 2 kHz
+            Pipeline pipeline;
+            pipeline.prepare(sampleRate, numPoints, scale, SpectrumMapper::Aggregation::max);
+            runSine(pipeline, 10000.0, 41, 0);
+
+            std::vector<float> curve((size_t)numPoints);
+            pipeline.map(0, curve.data());
+
+            auto crossoverPoint = getPointFor(sampleRate / 16.0);
+            auto peak = *std::max_element(curve.begin(), curve.end());
+            auto decimatedPeak = *std::max_element(curve.begin(), curve.begin() + crossoverPoint - 1);
+            expectLessOrEqual(decimatedPeak, peak * juce::Decibels::decibelsToGain(-60.0f));
+        }
+
+        beginTest("skipped frames still feed the decimated band");
+        {
+            // a band transforms every 4th frame at this hop, the 41st included, so both land on the same history
+            Pipeline processed, skipped;
+            for (auto* pipeline : { &processed, &skipped })
+                pipeline->prepare(sampleRate, numPoints, scale, SpectrumMapper::Aggregation::max);
+
+            runSine(processed, 100.0, 41, 0);
+            runSine(skipped, 100.0, 41, 40);
+
+            std::vector<float> a((size_t)numPoints), b((size_t)numPoints);
+            processed.map(0, a.data());
+            skipped.map(0, b.data());
+
+            expectLessOrEqual(getLargestDifference(a.data(), b.data(), numPoints), 1.0e-6f * *std::max_element(a.begin(), a.end()));
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int numPoints = 256;
+    static constexpr auto scale = SpectrumMapper::Scale::logarithmic;
+
+    /** The loudest decimated output of a unit sine, once the filter has filled. */
+    static float getDecimatedPeak(double cyclesPerSample)
+    {
+        Decimator decimator;
+        decimator.reset();
+
+        auto peak = 0.0f;
+        float output = 0.0f;
+
+        for (int i = 0; i < 8192; ++i)
+            if (decimator.push((float)std::sin(juce::MathConstants<double>::twoPi * cyclesPerSample * i), output) && i > 4 * Decimator::numTaps)
+                peak = juce::jmax(peak, std::abs(output));
+
+        return peak;
+    }
+
+    /** The display point whose range holds frequency, on the 20 Hz to 20 kHz axis the pipeline draws. */
+    static int getPointFor(double frequency)
+    {
+        auto low = SpectrumMapper::frequencyToScale(20.0f, scale);
+        auto high = SpectrumMapper::frequencyToScale(20000.0f, scale);
+        return (int)((float)numPoints * (SpectrumMapper::frequencyToScale((float)frequency, scale) - low) / (high - low));
+    }
+
+    /** numFrames windows of a sine, a quarter window apart, as the job would hand them over; the first
+        numSkipped of them go through skipFrame() instead. */
+    static void runSine(FFTPipeline& pipeline, double frequency, int numFrames, int numSkipped)
+    {
+        auto size = pipeline.getSize();
+        auto hop = size / 4;
+
+        SampleRing ring;
+        ring.prepare(2 * size);
+
+        std::vector<float> block((size_t)size);
+        juce::int64 sample = 0;
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            auto num = frame == 0 ? size : hop;
+            for (int i = 0; i < num; ++i)
+                block[(size_t)i] = 0.5f * (float)std::sin(juce::MathConstants<double>::twoPi * frequency * (double)sample++ / sampleRate);
+
+            ring.write(block.data(), num);
+
+            if (frame < numSkipped)
+                pipeline.skipFrame(ring, nullptr);
+            else
+                pipeline.processMono(ring);
+
+            ring.advance(hop);
+        }
+    }
+};
+static MultiResolutionTests multiResolutionTests;
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    OfflineAnalyzerTests.cpp
+    OfflineAnalyzer's chunks stitched back together, against one pass over
+    the whole file and against each window analyzed on its own.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/OfflineAnalyzer.h"
+#include "../../../Source/FFTPipeline.h"
+
+#include <vector>
+
+//==============================================================================
+struct OfflineAnalyzerTests : juce::UnitTest
+{
+    OfflineAnalyzerTests() : juce::UnitTest("OfflineAnalyzer", category) {}
+
+    void runTest() override
+    {
+        auto file = juce::File::createTempFile(".wav");
+
+        // a length that leaves a tail shorter than a hop, which only the last chunk owns
+        juce::AudioBuffer<float> audio(2, 20000);
+        auto& random = getRandom();
+
+        for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+            for (int i = 0; i < audio.getNumSamples(); ++i)
+                audio.setSample(ch, i, 0.5f * std::sin(0.01f * (float)(ch + 1) * (float)i) + 0.1f * (2.0f * random.nextFloat() - 1.0f));
+
+        beginTest("the test file writes");
+        expect(writeFile(file, audio));
+
+        OfflineAnalyzer::Settings settings;
+        settings.fftOrder = 10;
+        settings.numPoints = 64;
+        settings.keepSpectra = true;
+
+        // one chunk on one thread, then chunks of 3 frames, so boundaries fall all through the file, on 4
+        OfflineAnalyzer::Result whole, chunked;
+
+        settings.framesPerChunk = 100000;
+        settings.numThreads = 1;
+        auto error = OfflineAnalyzer::analyze(file, settings, whole);
+        expect(error.isEmpty(), error);
+
+        settings.framesPerChunk = 3;
+        settings.numThreads = 4;
+        error = OfflineAnalyzer::analyze(file, settings, chunked);
+        expect(error.isEmpty(), error);
+
+        file.deleteFile();
+
+        if (whole.spectra.empty() || chunked.spectra.empty())
+            return;
+
+        beginTest("every window that fits is a frame");
+        {
+            auto size = 1 << settings.fftOrder;
+            auto hop = size / 2;
+
+            expectEquals(whole.hopSize, hop);
+            expectEquals(whole.numFrames, (juce::int64)(1 + (audio.getNumSamples() - size) / hop));
+            expectEquals(chunked.numFrames, whole.numFrames);
+        }
+
+        beginTest("chunked frames are the frames of one pass over the file");
+        {
+            expectEquals(chunked.spectra.size(), whole.spectra.size());
+            expectLessOrEqual(getLargestDifference(chunked.spectra.data(), whole.spectra.data(), (int)whole.spectra.size()), 1.0e-4f);
+        }
+
+        beginTest("each frame is its own window, either side of a chunk boundary");
+        {
+            for (auto frame : { (juce::int64)0, (juce::int64)2, (juce::int64)3, chunked.numFrames - 1 })
+                for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+                    expectLessOrEqual(getLargestDifference(chunked.getFrame(ch, frame), analyzeWindow(audio, ch, frame, chunked, settings).data(), settings.numPoints), 1.0e-4f,
+                                      "frame " + juce::String(frame) + ", channel " + juce::String(ch));
+        }
+
+        beginTest("every sample counts towards peak and RMS exactly once");
+        {
+            for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+            {
+                auto range = juce::FloatVectorOperations::findMinAndMax(audio.getReadPointer(ch), audio.getNumSamples());
+                expectEquals(chunked.peak[(size_t)ch], juce::jmax(-range.getStart(), range.getEnd()));
+                expectWithinAbsoluteError(chunked.rms[(size_t)ch], audio.getRMSLevel(ch, 0, audio.getNumSamples()), 1.0e-5f);
+            }
+
+            expectLessOrEqual(getLargestDifference(chunked.averagedB.data(), whole.averagedB.data(), (int)whole.averagedB.size()), 1.0e-3f);
+            expectLessOrEqual(getLargestDifference(chunked.maxdB.data(), whole.maxdB.data(), (int)whole.maxdB.size()), 1.0e-4f);
+        }
+    }
+
+private:
+    static bool writeFile(const juce::File& file, const juce::AudioBuffer<float>& audio)
+    {
+        // 32-bit float, so the samples read back exactly
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(file.createOutputStream().release(), 48000.0,
+                                                                            (unsigned int)audio.getNumChannels(), 32, {}, 0));
+
+        return writer != nullptr && writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+    }
+
+    /** One window of one channel through a pipeline of its own, in dB the way the analyzer keeps them. */
+    static std::vector<float> analyzeWindow(const juce::AudioBuffer<float>& audio, int channel, juce::int64 frame,
+                                            const OfflineAnalyzer::Result& result, const OfflineAnalyzer::Settings& settings)
+    {
+        auto pipeline = createFFTPipeline(settings.fftOrder);
+        pipeline->prepare(result.sampleRate, settings.numPoints, settings.scale, settings.aggregation);
+
+        SampleRing ring;
+        ring.prepare(result.fftSize);
+        ring.write(audio.getReadPointer(channel, (int)(frame * result.hopSize)), result.fftSize);
+
+        std::vector<float> curve((size_t)settings.numPoints);
+        pipeline->processMono(ring);
+        pipeline->map(0, curve.data());
+
+        for (auto& level : curve)
+            level = juce::Decibels::gainToDecibels(level / (float)result.fftSize, settings.mindB);
+
+        return curve;
+    }
+};
+static OfflineAnalyzerTests offlineAnalyzerTests;
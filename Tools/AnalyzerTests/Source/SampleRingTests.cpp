@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    SampleRingTests.cpp
+    SampleRing's capacity, overflow and in-place reads across the wrap.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/SampleRing.h"
+
+#include <vector>
+
+//==============================================================================
+struct SampleRingTests : juce::UnitTest
+{
+    SampleRingTests() : juce::UnitTest("SampleRing", category) {}
+
+    void runTest() override
+    {
+        SampleRing ring;
+        ring.prepare(100);
+
+        std::vector<float> ramp(256);
+        for (size_t i = 0; i < ramp.size(); ++i)
+            ramp[i] = (float)i;
+
+        beginTest("capacity and overflow");
+        {
+            expectEquals(ring.getCapacity(), 128);
+            expectEquals(ring.write(ramp.data(), 100), 100);
+            expectEquals(ring.write(ramp.data() + 100, 50), 28);
+            expectEquals(ring.getNumReady(), 128);
+            expectEquals((int)ring.getStats().dropped, 22);
+
+            auto span = ring.peek(128);
+            expectEquals(span.firstSize, 128);
+            expectEquals(span.secondSize, 0);
+            expectEquals(span.first[127], 127.0f);
+        }
+
+        beginTest("peek across the wrap");
+        {
+            ring.advance(100);
+            expectEquals(ring.write(ramp.data() + 128, 90), 90);
+            expectEquals(ring.getNumReady(), 118);
+
+            auto span = ring.peek(118);
+            expectEquals(span.firstSize, 28);
+            expectEquals(span.secondSize, 90);
+
+            for (int i = 0; i < span.firstSize; ++i)
+                expectEquals(span.first[i], (float)(100 + i));
+            for (int i = 0; i < span.secondSize; ++i)
+                expectEquals(span.second[i], (float)(128 + i));
+
+            ring.advance(118);
+            expectEquals(ring.getNumReady(), 0);
+            expectEquals((int)ring.getReadPosition(), 218);
+            expectEquals((int)ring.getWritePosition(), 218);
+        }
+    }
+};
+static SampleRingTests sampleRingTests;
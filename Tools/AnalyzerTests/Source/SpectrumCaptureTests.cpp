@@ -0,0 +1,252 @@
+/*
+  ==============================================================================
+
+    SpectrumCaptureTests.cpp
+    A capture file written through SpectrumCapture and read back, buffered
+    and memory-mapped; what's taken between start() and stop(); and the
+    reader with files cut short or that aren't captures at all.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/SpectrumCapture.h"
+
+#include <array>
+
+//==============================================================================
+struct SpectrumCaptureTests : juce::UnitTest
+{
+    SpectrumCaptureTests() : juce::UnitTest("SpectrumCapture", category) {}
+
+    void runTest() override
+    {
+        for (auto memoryMapped : { false, true })
+        {
+            beginTest(memoryMapped ? "round trip, memory-mapped" : "round trip, buffered");
+
+            auto file = juce::File::createTempFile(".pfms");
+            roundTrip(file, memoryMapped);
+            file.deleteFile();
+        }
+
+        beginTest("frames are only taken between start and stop");
+        {
+            auto file = juce::File::createTempFile(".pfms");
+            startAndStop(file);
+            file.deleteFile();
+        }
+
+        beginTest("a file cut short reads up to its last whole frame");
+        {
+            auto file = juce::File::createTempFile(".pfms");
+            cutShort(file);
+            file.deleteFile();
+        }
+
+        beginTest("anything that isn't a whole capture header is rejected");
+        {
+            auto file = juce::File::createTempFile(".pfms");
+            rejectNonCaptures(file);
+            file.deleteFile();
+        }
+    }
+
+private:
+    // not a multiple of 8, so every record carries padding
+    static constexpr int numPoints = 13;
+    static constexpr int numFrames = 1000;
+
+    static uint8_t levelFor(juce::int64 frame, int point) { return (uint8_t)((frame * 7 + point) & 0xff); }
+
+    static void pushFrame(SpectrumCapture& capture, juce::int64 frame)
+    {
+        std::array<uint8_t, numPoints> levels;
+        for (int p = 0; p < numPoints; ++p)
+            levels[(size_t)p] = levelFor(frame, p);
+
+        capture.push((int)(frame % 2), 2048, frame * 1024, levels.data());
+    }
+
+    void startAndStop(const juce::File& file)
+    {
+        SpectrumCapture capture;
+
+        expect(capture.start(file, 48000.0, 0, {}).isNotEmpty());
+        expect(capture.start(file, 48000.0, SpectrumCapture::maxPoints + 1, {}).isNotEmpty());
+        expect(! capture.isCapturing());
+
+        // before start() a frame isn't written, queued or counted as dropped
+        pushFrame(capture, 0);
+        expectEquals(capture.getNumFramesWritten() + capture.getNumFramesDropped(), (juce::int64)0);
+
+        auto error = capture.start(file, 48000.0, numPoints, {});
+        expect(error.isEmpty(), error);
+        expect(capture.isCapturing());
+
+        for (juce::int64 frame = 1; frame <= 3; ++frame)
+            pushFrame(capture, frame);
+
+        capture.stop();
+        expect(! capture.isCapturing());
+
+        // stop() writes out everything already pushed, and ignores the rest
+        pushFrame(capture, 4);
+        expectEquals(capture.getNumFramesWritten(), (juce::int64)3);
+        expectEquals(capture.getNumFramesDropped(), (juce::int64)0);
+
+        SpectrumCaptureReader reader(file);
+        expect(reader.isValid());
+        if (reader.isValid())
+        {
+            expectEquals(reader.getNumFrames(), (juce::int64)3);
+            expectEquals(reader.getFrame(0).header->samplePosition, (int64_t)1024);
+        }
+    }
+
+    void cutShort(const juce::File& file)
+    {
+        constexpr juce::int64 numWritten = 10;
+
+        {
+            SpectrumCapture capture;
+            auto error = capture.start(file, 48000.0, numPoints, {});
+            expect(error.isEmpty(), error);
+
+            for (juce::int64 frame = 0; frame < numWritten; ++frame)
+                pushFrame(capture, frame);
+
+            capture.stop();
+            expectEquals(capture.getNumFramesWritten(), numWritten);
+        }
+
+        // as a crash part way through the last record would leave it
+        auto frameBytes = (juce::int64)(sizeof(CaptureFrameHeader) + getCaptureLevelBytes(numPoints));
+        expectEquals(file.getSize(), (juce::int64)sizeof(CaptureFileHeader) + numWritten * frameBytes);
+
+        {
+            juce::FileOutputStream out(file);
+            expect(out.openedOk());
+            out.setPosition(file.getSize() - frameBytes / 2);
+            out.truncate();
+        }
+
+        SpectrumCaptureReader reader(file);
+        expect(reader.isValid());
+        if (! reader.isValid())
+            return;
+
+        expectEquals(reader.getNumFrames(), numWritten - 1);
+
+        auto last = reader.getFrame(numWritten - 2);
+        expectEquals(last.header->samplePosition, (int64_t)((numWritten - 2) * 1024));
+        for (int p = 0; p < numPoints; ++p)
+            expectEquals((int)last.levels[p], (int)levelFor(numWritten - 2, p));
+    }
+
+    void rejectNonCaptures(const juce::File& file)
+    {
+        expect(! SpectrumCaptureReader(file.getSiblingFile("missing.pfms")).isValid());
+
+        CaptureFileHeader header;
+        header.numPoints = numPoints;
+        header.frameBytes = (uint32_t)(sizeof(CaptureFrameHeader) + getCaptureLevelBytes(numPoints));
+        header.sampleRate = 48000.0;
+
+        auto isValidWith = [&](const CaptureFileHeader& candidate, size_t numBytes)
+        {
+            file.replaceWithData(&candidate, numBytes);
+            return SpectrumCaptureReader(file).isValid();
+        };
+
+        // the header as the writer makes it is fine with no frames after it, and nothing else is
+        expect(isValidWith(header, sizeof(header)));
+        expect(! isValidWith(header, sizeof(header) - 1), "shorter than a header");
+
+        auto other = header;
+        other.magic[0] = 'X';
+        expect(! isValidWith(other, sizeof(other)), "wrong magic");
+
+        other = header;
+        other.version = CaptureFileHeader::currentVersion - 1;
+        expect(! isValidWith(other, sizeof(other)), "an older version, with records of another layout");
+
+        other = header;
+        other.frameBytes = (uint32_t)(sizeof(CaptureFrameHeader) + numPoints);
+        expect(! isValidWith(other, sizeof(other)), "unpadded records");
+    }
+
+    void roundTrip(const juce::File& file, bool memoryMapped)
+    {
+        SpectrumCapture::Options options;
+        options.memoryMapped = memoryMapped;
+        options.mappedWindowBytes = 4096;   // small enough that the capture crosses several windows
+
+        SpectrumCapture capture;
+        auto error = capture.start(file, 48000.0, numPoints, options);
+
+        if (memoryMapped && error.isNotEmpty())
+        {
+            logMessage("skipped: " + error);
+            return;
+        }
+
+        expect(error.isEmpty(), error);
+
+        std::array<uint8_t, numPoints> levels;
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            for (int p = 0; p < numPoints; ++p)
+                levels[(size_t)p] = levelFor(frame, p);
+
+            capture.push(frame % 2, 2048, (juce::int64)frame * 1024, levels.data());
+
+            // give the writer a chance, so most frames make it through the queue
+            if (frame % 64 == 63)
+                juce::Thread::sleep(25);
+        }
+
+        capture.stop();
+
+        auto written = capture.getNumFramesWritten();
+        expectEquals(written + capture.getNumFramesDropped(), (juce::int64)numFrames);
+        expectGreaterThan(written, (juce::int64)0);
+
+        SpectrumCaptureReader reader(file);
+        expect(reader.isValid());
+        if (! reader.isValid())
+            return;
+
+        const auto& header = reader.getHeader();
+        expectEquals((int)header.version, (int)CaptureFileHeader::currentVersion);
+        expectEquals((int)header.numPoints, numPoints);
+        expectEquals((int)header.frameBytes % 8, 0);
+        expectEquals(header.sampleRate, 48000.0);
+        expectEquals(reader.getNumFrames(), written);
+
+        juce::int64 previousPosition = -1;
+
+        for (juce::int64 i = 0; i < reader.getNumFrames(); ++i)
+        {
+            auto frame = reader.getFrame(i);
+            expectEquals((int)(reinterpret_cast<uintptr_t>(frame.header) % alignof(CaptureFrameHeader)), 0);
+
+            // frames come out in the order they were pushed, less any that were dropped
+            auto position = frame.header->samplePosition;
+            expect(position > previousPosition && position % 1024 == 0);
+            previousPosition = position;
+
+            auto pushed = position / 1024;
+            expectEquals((int)frame.header->channel, (int)(pushed % 2));
+            expectEquals((int)frame.header->fftSize, 2048);
+            expect(reader.getSeconds(frame) >= 0.0);
+
+            for (int p = 0; p < numPoints; ++p)
+                expectEquals((int)frame.levels[p], (int)levelFor(pushed, p));
+
+            expectEquals(frame.getLevel(0), (float)levelFor(pushed, 0) / 255.0f);
+        }
+    }
+};
+static SpectrumCaptureTests spectrumCaptureTests;
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    SpectrumMapperTests.cpp
+    SpectrumMapper's log, mel and Bark tables, and max against mean
+    aggregation.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/SpectrumMapper.h"
+
+#include <algorithm>
+#include <vector>
+
+//==============================================================================
+struct SpectrumMapperTests : juce::UnitTest
+{
+    SpectrumMapperTests() : juce::UnitTest("SpectrumMapper", category) {}
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int fftSize = 2048, numBins = fftSize / 2 + 1, numPoints = 512;
+        constexpr float minFrequency = 20.0f, maxFrequency = 20000.0f;
+
+        using Scale = SpectrumMapper::Scale;
+        using Aggregation = SpectrumMapper::Aggregation;
+
+        for (auto scale : { Scale::logarithmic, Scale::mel, Scale::bark })
+        {
+            auto name = juce::String(scale == Scale::logarithmic ? "log" : scale == Scale::mel ? "mel" : "Bark");
+
+            beginTest(name + " axis round trip");
+            for (auto frequency : { 20.0f, 100.0f, 1000.0f, 5000.0f, 20000.0f })
+            {
+                auto back = SpectrumMapper::scaleToFrequency(SpectrumMapper::frequencyToScale(frequency, scale), scale);
+                expectWithinAbsoluteError(back, frequency, frequency * 1.0e-4f);
+            }
+
+            beginTest(name + " table spaces points evenly on the axis");
+            {
+                SpectrumMapper mapper;
+                mapper.prepare(sampleRate, fftSize, numPoints, scale, Aggregation::max, minFrequency, maxFrequency);
+                expectEquals(mapper.getNumPoints(), numPoints);
+
+                auto scaleMin = SpectrumMapper::frequencyToScale(minFrequency, scale);
+                auto scaleMax = SpectrumMapper::frequencyToScale(maxFrequency, scale);
+
+                for (int i = 0; i < numPoints; ++i)
+                {
+                    auto expected = SpectrumMapper::scaleToFrequency(juce::jmap((float)i + 0.5f, 0.0f, (float)numPoints, scaleMin, scaleMax), scale);
+                    expectWithinAbsoluteError(mapper.getFrequencyForPoint(i), expected, expected * 0.01f);
+
+                    if (i > 0)
+                        expect(mapper.getFrequencyForPoint(i) > mapper.getFrequencyForPoint(i - 1));
+                }
+            }
+        }
+
+        std::vector<float> magnitudes((size_t)numBins), maxOut((size_t)numPoints), meanOut((size_t)numPoints);
+        SpectrumMapper maxMapper, meanMapper;
+        maxMapper.prepare(sampleRate, fftSize, numPoints, Scale::logarithmic, Aggregation::max);
+        meanMapper.prepare(sampleRate, fftSize, numPoints, Scale::logarithmic, Aggregation::mean);
+
+        beginTest("flat spectrum stays flat");
+        {
+            std::fill(magnitudes.begin(), magnitudes.end(), 0.25f);
+            maxMapper.process(magnitudes.data(), maxOut.data());
+            meanMapper.process(magnitudes.data(), meanOut.data());
+
+            for (int i = 0; i < numPoints; ++i)
+            {
+                expectWithinAbsoluteError(maxOut[(size_t)i], 0.25f, 1.0e-6f);
+                expectWithinAbsoluteError(meanOut[(size_t)i], 0.25f, 1.0e-6f);
+            }
+        }
+
+        beginTest("max keeps a lone bin, mean spreads it");
+        {
+            // near 10 kHz each point spans several bins
+            auto bin = juce::roundToInt(10000.0 * fftSize / sampleRate);
+            auto binFrequency = (float)(bin * sampleRate / fftSize);
+
+            std::fill(magnitudes.begin(), magnitudes.end(), 0.0f);
+            magnitudes[(size_t)bin] = 1.0f;
+            maxMapper.process(magnitudes.data(), maxOut.data());
+            meanMapper.process(magnitudes.data(), meanOut.data());
+
+            auto peak = std::max_element(maxOut.begin(), maxOut.end());
+            expectEquals(*peak, 1.0f);
+            expectWithinAbsoluteError(maxMapper.getFrequencyForPoint((int)(peak - maxOut.begin())), binFrequency, binFrequency * 0.02f);
+
+            auto meanPeak = *std::max_element(meanOut.begin(), meanOut.end());
+            expect(meanPeak > 0.0f && meanPeak <= 0.5f, "the mean of a multi-bin point should dilute one bin");
+        }
+
+        beginTest("max is never below mean");
+        {
+            for (int b = 0; b < numBins; ++b)
+                magnitudes[(size_t)b] = (float)b;
+
+            maxMapper.process(magnitudes.data(), maxOut.data());
+            meanMapper.process(magnitudes.data(), meanOut.data());
+
+            for (int i = 0; i < numPoints; ++i)
+                expect(maxOut[(size_t)i] >= meanOut[(size_t)i] - 1.0e-3f);
+
+            expect(maxOut.back() > meanOut.back(), "the top point spans several bins");
+        }
+    }
+};
+static SpectrumMapperTests spectrumMapperTests;
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    SpectrumSmootherTests.cpp
+    SpectrumSmoother's dB scale, attack and release, and peak hold.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/SpectrumSmoother.h"
+
+#include <vector>
+
+//==============================================================================
+struct SpectrumSmootherTests : juce::UnitTest
+{
+    SpectrumSmootherTests() : juce::UnitTest("SpectrumSmoother", category) {}
+
+    void runTest() override
+    {
+        // not a whole number of registers, so the padding lanes are in play
+        constexpr int numPoints = 13;
+        constexpr double framesPerSecond = 100.0;
+
+        SpectrumSmoother::Ballistics ballistics;
+        ballistics.attackMs = 20.0f;                // 2 frames
+        ballistics.releaseMs = 250.0f;              // 25 frames
+        ballistics.peakHoldMs = 500.0f;             // 50 frames
+        ballistics.peakDecayDbPerSecond = 20.0f;    // 0.2 dB, or 0.002 of the range, per frame
+
+        SpectrumSmoother smoother;
+        smoother.prepare(numPoints, -100.0f, 0.0f);
+        smoother.setFrameRate(framesPerSecond, ballistics);
+
+        std::vector<float> loud((size_t)numPoints, 0.1f), silent((size_t)numPoints, 0.0f);
+        auto loudLevel = 0.8f;   // -20 dB on a -100..0 dB range
+
+        beginTest("a steady input settles on its level in dB");
+        {
+            // referenceGain scales the magnitudes first, so 0.4 against 4 reads the same -20 dB
+            std::vector<float> scaled((size_t)numPoints, 0.4f);
+            for (int frame = 0; frame < 200; ++frame)
+                smoother.process(scaled.data(), 4.0f);
+
+            for (int i = 0; i < numPoints; ++i)
+                expectWithinAbsoluteError(smoother.getLevels()[i], loudLevel, 1.0e-4f);
+
+            std::vector<uint8_t> quantized((size_t)numPoints);
+            smoother.getQuantizedLevels(quantized.data());
+            expectEquals((int)quantized[(size_t)numPoints - 1], 204);
+        }
+
+        beginTest("attack and release follow their time constants");
+        {
+            smoother.reset();
+            smoother.process(loud.data(), 1.0f);
+
+            auto attack = (float)(1.0 - std::exp(-1.0 / 2.0));
+            expectWithinAbsoluteError(smoother.getLevels()[0], attack * loudLevel, 1.0e-4f);
+
+            for (int frame = 0; frame < 200; ++frame)
+                smoother.process(loud.data(), 1.0f);
+
+            // silence is clamped to the bottom of the range, level 0
+            smoother.process(silent.data(), 1.0f);
+
+            auto release = (float)(1.0 - std::exp(-1.0 / 25.0));
+            expectWithinAbsoluteError(smoother.getLevels()[0], loudLevel * (1.0f - release), 1.0e-4f);
+        }
+
+        beginTest("peaks hold, then decay at their rate");
+        {
+            smoother.reset();
+            smoother.process(loud.data(), 1.0f);
+            expectWithinAbsoluteError(smoother.getPeaks()[0], loudLevel, 1.0e-4f);
+
+            for (int frame = 0; frame < 50; ++frame)
+                smoother.process(silent.data(), 1.0f);
+
+            expectWithinAbsoluteError(smoother.getPeaks()[numPoints - 1], loudLevel, 1.0e-4f);
+
+            smoother.process(silent.data(), 1.0f);
+            expectWithinAbsoluteError(smoother.getPeaks()[numPoints - 1], loudLevel - 0.002f, 1.0e-4f);
+
+            // it never decays below the current level
+            for (int frame = 0; frame < 1000; ++frame)
+                smoother.process(silent.data(), 1.0f);
+
+            expectGreaterOrEqual(smoother.getPeaks()[0], smoother.getLevels()[0]);
+        }
+
+        beginTest("new ballistics carry on from the current curve");
+        {
+            for (int frame = 0; frame < 200; ++frame)
+                smoother.process(loud.data(), 1.0f);
+
+            // only the coefficients change, so a slower release starts from where the curve is
+            ballistics.releaseMs = 1000.0f;
+            smoother.setFrameRate(framesPerSecond, ballistics);
+            expectWithinAbsoluteError(smoother.getLevels()[0], loudLevel, 1.0e-4f);
+
+            smoother.process(silent.data(), 1.0f);
+
+            auto release = (float)(1.0 - std::exp(-1.0 / 100.0));
+            expectWithinAbsoluteError(smoother.getLevels()[0], loudLevel * (1.0f - release), 1.0e-4f);
+        }
+    }
+};
+static SpectrumSmootherTests spectrumSmootherTests;
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    StereoTests.cpp
+    A stereo frame's two spectra against processMono of each channel, with
+    and without the complex bins behind the cross-channel spectra.
+
+  ==============================================================================
+*/
+
+#include "AnalyzerTests.h"
+#include "../../../Source/FFTPipeline.h"
+
+#include <algorithm>
+#include <vector>
+
+//==============================================================================
+struct StereoTests : juce::UnitTest
+{
+    StereoTests() : juce::UnitTest("Stereo", category) {}
+
+    void runTest() override
+    {
+        constexpr int order = 11, size = 1 << order, numBins = size / 2 + 1;
+        constexpr float tolerance = 1.0e-4f * (float)size;
+
+        auto& random = getRandom();
+        SampleRing left, right;
+        left.prepare(size);
+        right.prepare(size);
+        writeSine(left, size, 20, 0.8f, 0.1f, random);
+        writeSine(right, size, 100, 0.5f, 0.3f, random);
+
+        StereoSpectrum spectrum;
+        spectrum.allocate(numBins);
+
+        // complex bins with the stereo spectra, magnitudes straight from the backend without them
+        for (auto* stereoSpectrum : { &spectrum, (StereoSpectrum*)nullptr })
+        {
+            beginTest(stereoSpectrum != nullptr ? "with the stereo spectra the channels match processMono"
+                                                : "without them the channels match processMono too");
+
+            auto stereo = std::make_unique<FixedSizeFFTPipeline<order>>();
+            auto mono = std::make_unique<FixedSizeFFTPipeline<order>>();
+
+            spectrum.numBins = 0;
+            stereo->processStereo(left, right, stereoSpectrum);
+            expectEquals(spectrum.numBins, stereoSpectrum != nullptr ? numBins : 0);
+
+            mono->processMono(left);
+            expectLessOrEqual(getLargestDifference(stereo->getMagnitudes(), mono->getMagnitudes(), numBins), tolerance);
+
+            mono->processMono(right);
+            expectLessOrEqual(getLargestDifference(stereo->getPartnerMagnitudes(), mono->getMagnitudes(), numBins), tolerance);
+
+            // the rings are only peeked at, so the same frame is still there for the next test
+            expectEquals(left.getNumReady(), size);
+        }
+
+        beginTest("identical channels are all mid and fully correlated");
+        {
+            auto stereo = std::make_unique<FixedSizeFFTPipeline<order>>();
+            stereo->processStereo(left, left, &spectrum);
+
+            expectLessOrEqual(getLargestDifference(stereo->getMagnitudes(), stereo->getPartnerMagnitudes(), numBins), tolerance);
+            expectLessOrEqual(getLargestDifference(spectrum.mid.data(), stereo->getMagnitudes(), numBins), tolerance);
+            expectLessOrEqual(*std::max_element(spectrum.side.begin(), spectrum.side.begin() + numBins), tolerance);
+            expectGreaterThan(spectrum.correlation[20], 0.99f);
+            expectWithinAbsoluteError(spectrum.phase[20], 0.0f, 1.0e-3f);
+        }
+
+        beginTest("inverted channels are all side and fully anticorrelated");
+        {
+            SampleRing inverted;
+            inverted.prepare(size);
+
+            auto span = left.peek(size);
+            std::vector<float> samples((size_t)size);
+            for (int i = 0; i < size; ++i)
+                samples[(size_t)i] = -(i < span.firstSize ? span.first[i] : span.second[i - span.firstSize]);
+
+            inverted.write(samples.data(), size);
+
+            auto stereo = std::make_unique<FixedSizeFFTPipeline<order>>();
+            stereo->processStereo(left, inverted, &spectrum);
+
+            expectLessOrEqual(getLargestDifference(spectrum.side.data(), stereo->getMagnitudes(), numBins), tolerance);
+            expectLessOrEqual(*std::max_element(spectrum.mid.begin(), spectrum.mid.begin() + numBins), tolerance);
+            expectLessOrEqual(spectrum.correlation[20], -0.99f);
+            expectWithinAbsoluteError(std::abs(spectrum.phase[20]), juce::MathConstants<float>::pi, 1.0e-3f);
+        }
+    }
+};
+static StereoTests stereoTests;
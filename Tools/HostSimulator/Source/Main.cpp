@@ -0,0 +1,422 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Headless host that drives many processor instances with host-like block
+    sizes and reports processBlock timing, analyzer frame drops and threads.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /** Threads in this process, or -1 where /proc isn't available. */
+    int countThreads()
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+
+        while (std::getline(status, line))
+            if (line.rfind("Threads:", 0) == 0)
+                return std::atoi(line.c_str() + 8);
+
+        return -1;
+    }
+
+    double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+
+        auto index = (size_t)std::ceil(fraction * (double)sorted.size());
+        return sorted[juce::jlimit((size_t)0, sorted.size() - 1, index == 0 ? 0 : index - 1)];
+    }
+}
+
+//==============================================================================
+struct Configuration
+{
+    int numInstances = 1;
+    int blockSize = 512;
+    double sampleRate = 48000.0;
+    double seconds = 10.0;
+    bool realtime = false;
+    float maxOversize = 4.0f;   // largest block, as a multiple of the prepared block size
+    int seed = 1;
+    juce::File captureDirectory;   // the first instance's frames are captured here, if set
+    bool captureMemoryMapped = false;
+    bool watched = true;           // whether every instance has an editor open
+    bool averageSkipped = false;   // average the frames the editor wouldn't draw rather than skip them
+};
+
+//==============================================================================
+/**
+    Stands in for an open editor: attached as both engines' curve consumer, taking curves as the analyzers would
+    at the frame scheduler's cap. There's no display to sync to here, so it runs off its own timer.
+*/
+struct SimulatedEditor : juce::Timer
+{
+    static constexpr double frameRate = FrameScheduler::defaultMaxFrameRate;
+
+    explicit SimulatedEditor(PFMProject0AudioProcessor& p) : processor(p)
+    {
+        processor.leftAnalysisEngine.attach(AnalysisConsumers::curve, frameRate);
+        processor.rightAnalysisEngine.attach(AnalysisConsumers::curve, frameRate);
+
+        // the editor's default size, so the curves are rasterized as they would be on screen
+        processor.leftAnalysisEngine.setCurveSize(400, 150);
+        processor.rightAnalysisEngine.setCurveSize(400, 150);
+        startTimerHz(juce::roundToInt(frameRate));
+    }
+
+    ~SimulatedEditor() override
+    {
+        stopTimer();
+        processor.leftAnalysisEngine.detach(AnalysisConsumers::curve, frameRate);
+        processor.rightAnalysisEngine.detach(AnalysisConsumers::curve, frameRate);
+    }
+
+    void timerCallback() override
+    {
+        for (auto* engine : { &processor.leftAnalysisEngine, &processor.rightAnalysisEngine })
+        {
+            // as the analyzers' frame ticks do
+            engine->applyPendingSettings();
+
+            auto& curves = engine->getCurves();
+            PathPool::Handle h;
+            curves.noteWakeup();
+            while (curves.receive(h))
+                curves.recycle(h);
+        }
+    }
+
+    PFMProject0AudioProcessor& processor;
+};
+
+//==============================================================================
+/**
+    Runs every configuration on its own thread, standing in for the host's
+    audio callback, while the main thread runs the message loop so the
+    simulated editors keep draining their path pools as they would in a host.
+*/
+struct Simulation : juce::Thread
+{
+    explicit Simulation(std::vector<Configuration> configurations) :
+        Thread("Simulated Audio"), configs(std::move(configurations))
+    {
+    }
+
+    void run() override
+    {
+        for (const auto& config : configs)
+        {
+            if (threadShouldExit())
+                break;
+
+            results.add(runConfiguration(config));
+        }
+
+        juce::MessageManager::getInstance()->stopDispatchLoop();
+    }
+
+    juce::Array<juce::var> results;
+
+private:
+    std::vector<Configuration> configs;
+
+    static int getMaxBlockSize(const Configuration& config)
+    {
+        return juce::jmax(config.blockSize, (int)((float)config.blockSize * config.maxOversize));
+    }
+
+    /** Mostly the prepared size, sometimes smaller, occasionally larger than promised, as real hosts do. */
+    static int nextBlockSize(juce::Random& random, const Configuration& config)
+    {
+        auto dice = random.nextFloat();
+        auto largest = getMaxBlockSize(config);
+
+        if (dice < 0.7f || (dice >= 0.9f && largest == config.blockSize))
+            return config.blockSize;
+
+        if (dice < 0.9f)
+            return 1 + random.nextInt(config.blockSize);
+
+        return config.blockSize + 1 + random.nextInt(largest - config.blockSize);
+    }
+
+    juce::var runConfiguration(const Configuration& config)
+    {
+        std::vector<std::unique_ptr<PFMProject0AudioProcessor>> processors;
+        std::vector<std::unique_ptr<SimulatedEditor>> editors;
+
+        {
+            const juce::MessageManagerLock lock(this);
+            if (! lock.lockWasGained())
+                return {};
+
+            for (int i = 0; i < config.numInstances; ++i)
+            {
+                auto processor = std::make_unique<PFMProject0AudioProcessor>();
+                processor->setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
+                processor->prepareToPlay(config.sampleRate, config.blockSize);
+                *processor->playSound = true;
+
+                // on both, since a mono layout or an unlinked right channel runs its own job
+                if (config.averageSkipped)
+                    for (auto* engine : { &processor->leftAnalysisEngine, &processor->rightAnalysisEngine })
+                        engine->setDecimation(FFTProcessingJob::Decimation::average);
+
+                if (config.watched)
+                    editors.push_back(std::make_unique<SimulatedEditor>(*processor));
+
+                processors.push_back(std::move(processor));
+            }
+        }
+
+        if (config.captureDirectory != juce::File())
+        {
+            auto captureFile = config.captureDirectory.getChildFile("capture-" + juce::String(config.numInstances) + "x"
+                                                                    + juce::String(config.blockSize) + ".pfmspec");
+            auto error = processors.front()->startCapture(captureFile, config.captureMemoryMapped);
+
+            if (error.isNotEmpty())
+                std::cerr << error << std::endl;
+        }
+
+        auto numChannels = processors.front()->getTotalNumOutputChannels();
+        auto maxBlockSize = getMaxBlockSize(config);
+
+        juce::AudioBuffer<float> buffer(numChannels, maxBlockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(config.seed);
+
+        auto totalSamples = (int64_t)(config.seconds * config.sampleRate);
+        std::vector<double> callNs;
+        callNs.reserve((size_t)(config.numInstances * (totalSamples / juce::jmax(1, config.blockSize / 2) + 16)));
+
+        int64_t samplesDone = 0, callbacks = 0, deadlineMisses = 0;
+        double processingSeconds = 0.0;
+        int maxThreads = countThreads();
+
+        auto start = std::chrono::steady_clock::now();
+
+        while (samplesDone < totalSamples && ! threadShouldExit())
+        {
+            auto numSamples = nextBlockSize(random, config);
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+            auto callbackStart = std::chrono::steady_clock::now();
+
+            for (auto& processor : processors)
+            {
+                auto callStart = std::chrono::steady_clock::now();
+                processor->processBlock(block, midi);
+                callNs.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - callStart).count());
+            }
+
+            auto callbackSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - callbackStart).count();
+            processingSeconds += callbackSeconds;
+
+            // every instance shares one callback, so together they have to fit in one block's worth of time
+            if (callbackSeconds > (double)numSamples / config.sampleRate)
+                ++deadlineMisses;
+
+            samplesDone += numSamples;
+
+            if (++callbacks % 64 == 0)
+                maxThreads = juce::jmax(maxThreads, countThreads());
+
+            if (config.realtime)
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                          std::chrono::duration<double>((double)samplesDone / config.sampleRate)));
+        }
+
+        auto wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // give the pool a moment to finish what's already queued before counting
+        juce::Thread::sleep(200);
+
+        int64_t framesAnalysed = 0, framesSkipped = 0, framesDecimated = 0, samplesDropped = 0, curvesDropped = 0;
+        QueueStats workerPool;
+
+        for (auto& processor : processors)
+        {
+            auto stats = processor->getPipelineStats();
+            framesAnalysed += stats.framesAnalysed;
+            framesSkipped += stats.framesSkipped;
+            framesDecimated += stats.framesDecimated;
+            samplesDropped += (int64_t)(stats.leftSamples.dropped + stats.rightSamples.dropped);
+            curvesDropped += (int64_t)(stats.leftCurves.dropped + stats.rightCurves.dropped);
+            workerPool = stats.workerPool;
+        }
+
+        // flushes whatever the writer hasn't got to yet, so the counts are final
+        processors.front()->stopCapture();
+        auto captureStats = processors.front()->getPipelineStats();
+
+        // hops, each of which ends up analysed, decimated or skipped; only instances something is attached to take any
+        auto numAnalyzing = config.watched ? config.numInstances : (config.captureDirectory != juce::File() ? 1 : 0);
+        auto framesExpected = (double)numAnalyzing * (double)(samplesDone - FFTSizes::fftSize) / (double)(FFTSizes::fftSize / 2);
+
+        {
+            const juce::MessageManagerLock lock(this);
+            editors.clear();
+            processors.clear();
+        }
+
+        std::sort(callNs.begin(), callNs.end());
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("instances", config.numInstances);
+        result->setProperty("blockSize", config.blockSize);
+        result->setProperty("maxBlockSize", maxBlockSize);
+        result->setProperty("sampleRate", config.sampleRate);
+        result->setProperty("realtime", config.realtime);
+        result->setProperty("watched", config.watched);
+        result->setProperty("audioSeconds", (double)samplesDone / config.sampleRate);
+        result->setProperty("wallSeconds", wallSeconds);
+        result->setProperty("callbacks", (double)callbacks);
+        result->setProperty("processBlockNsMean", callNs.empty() ? 0.0 : std::accumulate(callNs.begin(), callNs.end(), 0.0) / (double)callNs.size());
+        result->setProperty("processBlockNsP50", percentile(callNs, 0.5));
+        result->setProperty("processBlockNsP99", percentile(callNs, 0.99));
+        result->setProperty("processBlockNsP999", percentile(callNs, 0.999));
+        result->setProperty("processBlockNsMax", callNs.empty() ? 0.0 : callNs.back());
+        result->setProperty("callbackLoad", processingSeconds * config.sampleRate / (double)samplesDone);
+        result->setProperty("deadlineMisses", (double)deadlineMisses);
+        result->setProperty("framesExpected", juce::jmax(0.0, framesExpected));
+        result->setProperty("framesAnalysed", (double)framesAnalysed);
+        result->setProperty("framesSkipped", (double)framesSkipped);
+        result->setProperty("framesDecimated", (double)framesDecimated);
+        result->setProperty("averageSkipped", config.averageSkipped);
+        result->setProperty("samplesDropped", (double)samplesDropped);
+        result->setProperty("curvesDropped", (double)curvesDropped);
+        result->setProperty("poolSubmissionsRefused", (double)workerPool.dropped);
+        result->setProperty("poolPeakQueued", (double)workerPool.peakOccupancy);
+        result->setProperty("maxThreads", maxThreads);
+
+        if (config.captureDirectory != juce::File())
+        {
+            result->setProperty("framesCaptured", (double)captureStats.framesCaptured);
+            result->setProperty("framesCaptureDropped", (double)captureStats.framesCaptureDropped);
+        }
+
+        std::cerr << config.numInstances << " instances, block " << config.blockSize
+                  << ": p99.9 " << juce::String(percentile(callNs, 0.999) / 1000.0, 1) << " us"
+                  << ", max " << juce::String((callNs.empty() ? 0.0 : callNs.back()) / 1000.0, 1) << " us"
+                  << ", " << framesSkipped << " frames skipped, " << maxThreads << " threads" << std::endl;
+
+        return juce::var(result);
+    }
+};
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        std::cout << "HostSimulator [--instances 1,2,4,8] [--block 64,512] [--sample-rate 48000] [--seconds 10]\n"
+                     "              [--max-oversize 4] [--realtime] [--seed 1] [--output <file.json>]\n"
+                     "              [--capture <dir> [--capture-mmap]] [--unwatched] [--average-skipped]" << std::endl;
+        return 0;
+    }
+
+    auto listOption = [&args](const juce::String& option, const juce::String& fallback)
+    {
+        auto value = args.getValueForOption(option);
+        auto items = juce::StringArray::fromTokens(value.isNotEmpty() ? value : fallback, ",", {});
+
+        std::vector<int> numbers;
+        for (const auto& item : items)
+            if (item.getIntValue() > 0)
+                numbers.push_back(item.getIntValue());
+
+        return numbers;
+    };
+
+    auto doubleOption = [&args](const juce::String& option, double fallback)
+    {
+        auto value = args.getValueForOption(option);
+        return value.isNotEmpty() ? value.getDoubleValue() : fallback;
+    };
+
+    auto captureOption = args.getValueForOption("--capture");
+    auto captureDirectory = captureOption.isNotEmpty() ? juce::File::getCurrentWorkingDirectory().getChildFile(captureOption) : juce::File();
+
+    if (captureDirectory != juce::File() && ! captureDirectory.createDirectory())
+    {
+        std::cerr << "could not create " << captureDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    std::vector<Configuration> configurations;
+
+    for (auto blockSize : listOption("--block", "64,512"))
+    {
+        for (auto numInstances : listOption("--instances", "1,2,4,8,16"))
+        {
+            Configuration config;
+            config.numInstances = numInstances;
+            config.blockSize = blockSize;
+            config.sampleRate = doubleOption("--sample-rate", 48000.0);
+            config.seconds = doubleOption("--seconds", 10.0);
+            config.maxOversize = (float)juce::jmax(1.0, doubleOption("--max-oversize", 4.0));
+            config.realtime = args.containsOption("--realtime");
+            config.seed = (int)doubleOption("--seed", 1.0);
+            config.captureDirectory = captureDirectory;
+            config.captureMemoryMapped = args.containsOption("--capture-mmap");
+            config.watched = ! args.containsOption("--unwatched");
+            config.averageSkipped = args.containsOption("--average-skipped");
+            configurations.push_back(config);
+        }
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    Simulation simulation(std::move(configurations));
+    simulation.startThread(juce::Thread::realtimeAudioPriority);
+
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    simulation.stopThread(-1);
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("simulator", "HostSimulator");
+    root->setProperty("cpus", juce::SystemStats::getNumCpus());
+    root->setProperty("fftSize", (int)FFTSizes::fftSize);
+    root->setProperty("results", simulation.results);
+
+    auto json = juce::JSON::toString(juce::var(root));
+    auto outputPath = args.getValueForOption("--output");
+
+    if (outputPath.isEmpty())
+    {
+        std::cout << json << std::endl;
+        return 0;
+    }
+
+    auto outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(outputPath);
+
+    if (! outputFile.replaceWithText(json))
+    {
+        std::cerr << "could not write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Runs the analyzer's spectral analysis over audio files on every core and
+    writes per-frame spectra and summary statistics.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/OfflineAnalyzer.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    juce::var toVar(const std::vector<float>& values, size_t start, size_t num)
+    {
+        juce::Array<juce::var> array;
+        array.ensureStorageAllocated((int)num);
+
+        for (size_t i = start; i < start + num; ++i)
+            array.add(values[i]);
+
+        return array;
+    }
+
+    juce::var summarize(const juce::File& file, const OfflineAnalyzer::Result& result, double seconds)
+    {
+        auto* root = new juce::DynamicObject();
+        root->setProperty("file", file.getFullPathName());
+        root->setProperty("sampleRate", result.sampleRate);
+        root->setProperty("lengthInSamples", result.lengthInSamples);
+        root->setProperty("fftSize", result.fftSize);
+        root->setProperty("hopSize", result.hopSize);
+        root->setProperty("numFrames", result.numFrames);
+        root->setProperty("numPoints", result.numPoints);
+        root->setProperty("analysisSeconds", seconds);
+        root->setProperty("pointFrequencies", toVar(result.pointFrequencies, 0, result.pointFrequencies.size()));
+
+        juce::Array<juce::var> channels;
+        auto numPoints = (size_t)result.numPoints;
+
+        for (int ch = 0; ch < result.numChannels; ++ch)
+        {
+            auto* channel = new juce::DynamicObject();
+            channel->setProperty("peak", result.peak[(size_t)ch]);
+            channel->setProperty("rms", result.rms[(size_t)ch]);
+            channel->setProperty("averagedB", toVar(result.averagedB, (size_t)ch * numPoints, numPoints));
+            channel->setProperty("maxdB", toVar(result.maxdB, (size_t)ch * numPoints, numPoints));
+            channels.add(juce::var(channel));
+        }
+
+        root->setProperty("channels", channels);
+        return juce::var(root);
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h") || args.size() == 0)
+    {
+        std::cout << "OfflineAnalysis <file.wav|aiff>... [--order <9..15>] [--hop <samples>] [--points <n>]" << std::endl
+                  << "                [--scale log|mel|bark] [--mean] [--threads <n>] [--summary-only]" << std::endl
+                  << "                [--output <dir>]" << std::endl
+                  << std::endl
+                  << "Prints a JSON summary per file. With --output, writes <name>.json and, unless" << std::endl
+                  << "--summary-only, <name>.spectra: float32 dB, channel-major, numFrames x numPoints." << std::endl;
+        return 0;
+    }
+
+    OfflineAnalyzer::Settings settings;
+
+    if (args.containsOption("--order"))   settings.fftOrder = args.getValueForOption("--order").getIntValue();
+    if (args.containsOption("--hop"))     settings.hopSize = args.getValueForOption("--hop").getIntValue();
+    if (args.containsOption("--points"))  settings.numPoints = args.getValueForOption("--points").getIntValue();
+    if (args.containsOption("--threads")) settings.numThreads = args.getValueForOption("--threads").getIntValue();
+
+    auto scale = args.getValueForOption("--scale");
+    if (scale == "mel")  settings.scale = SpectrumMapper::Scale::mel;
+    if (scale == "bark") settings.scale = SpectrumMapper::Scale::bark;
+
+    if (args.containsOption("--mean"))
+        settings.aggregation = SpectrumMapper::Aggregation::mean;
+
+    auto outputOption = args.getValueForOption("--output");
+    auto outputDirectory = outputOption.isNotEmpty() ? juce::File::getCurrentWorkingDirectory().getChildFile(outputOption) : juce::File();
+    settings.keepSpectra = outputDirectory != juce::File() && ! args.containsOption("--summary-only");
+
+    if (outputDirectory != juce::File() && ! outputDirectory.createDirectory())
+    {
+        std::cerr << "could not create " << outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    auto exitCode = 0;
+
+    // everything that isn't an option or an option's value is a file
+    const juce::StringArray valueOptions { "--order", "--hop", "--points", "--scale", "--threads", "--output" };
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+
+        if (arg.isOption())
+        {
+            if (valueOptions.contains(arg.text))
+                ++i;
+
+            continue;
+        }
+
+        auto file = arg.resolveAsFile();
+        OfflineAnalyzer::Result result;
+
+        auto start = std::chrono::steady_clock::now();
+        auto error = OfflineAnalyzer::analyze(file, settings, result);
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (error.isNotEmpty())
+        {
+            std::cerr << error << std::endl;
+            exitCode = 1;
+            continue;
+        }
+
+        std::cerr << file.getFileName() << ": " << result.numFrames << " frames x " << result.numChannels << " channels in "
+                  << juce::String(seconds, 2) << " s (" << juce::String((double)result.lengthInSamples / result.sampleRate / seconds, 0)
+                  << "x realtime)" << std::endl;
+
+        auto json = juce::JSON::toString(summarize(file, result, seconds));
+
+        if (outputDirectory == juce::File())
+        {
+            std::cout << json << std::endl;
+            continue;
+        }
+
+        auto summaryFile = outputDirectory.getChildFile(file.getFileNameWithoutExtension() + ".json");
+        auto ok = summaryFile.replaceWithText(json);
+
+        if (ok && settings.keepSpectra)
+        {
+            auto spectraFile = outputDirectory.getChildFile(file.getFileNameWithoutExtension() + ".spectra");
+            ok = spectraFile.replaceWithData(result.spectra.data(), result.spectra.size() * sizeof(float));
+        }
+
+        if (! ok)
+        {
+            std::cerr << "could not write to " << outputDirectory.getFullPathName() << std::endl;
+            exitCode = 1;
+        }
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Minimal monitoring process: finds every analyzer instance publishing in
+    shared memory and prints its meters a few times a second. Uses nothing
+    but POSIX and SharedSpectrumLayout.h, as a dashboard would.
+
+  ==============================================================================
+*/
+
+#include "../../../Source/SharedSpectrumLayout.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    /** A read-only view of one instance's segment. */
+    struct Instance
+    {
+        std::string name;
+        const SharedSpectrumLayout* layout = nullptr;
+    };
+
+    const SharedSpectrumLayout* openSegment(const std::string& name)
+    {
+        auto fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return nullptr;
+
+        // mapping past the end of the object would fault on the first read: one that's still being created has
+        // no size yet, and one from an older, smaller layout is too short
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SharedSpectrumLayout))
+        {
+            close(fd);
+            return nullptr;
+        }
+
+        auto* mapped = mmap(nullptr, sizeof(SharedSpectrumLayout), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (mapped == MAP_FAILED)
+            return nullptr;
+
+        auto* layout = static_cast<const SharedSpectrumLayout*>(mapped);
+
+        // a segment whose process has gone is left over from a crash
+        if (layout->magic != SharedSpectrumLayout::magicValue || layout->version != SharedSpectrumLayout::currentVersion
+            || kill((pid_t)layout->processId, 0) != 0)
+        {
+            munmap(mapped, sizeof(SharedSpectrumLayout));
+            return nullptr;
+        }
+
+        return layout;
+    }
+
+    /** Segment names given on the command line, or on Linux everything in /dev/shm that looks like one. */
+    std::vector<Instance> findInstances(int argc, char* argv[])
+    {
+        std::vector<std::string> names;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            // an option's value isn't a name
+            if (std::strcmp(argv[i], "--hz") == 0)
+                ++i;
+            else if (argv[i][0] != '-')
+                names.push_back(argv[i]);
+        }
+
+        if (names.empty())
+        {
+            if (auto* dir = opendir("/dev/shm"))
+            {
+                auto prefix = std::string(SharedSpectrumLayout::namePrefix + 1);   // without the leading '/'
+
+                while (auto* entry = readdir(dir))
+                    if (std::strncmp(entry->d_name, prefix.c_str(), prefix.size()) == 0)
+                        names.push_back("/" + std::string(entry->d_name));
+
+                closedir(dir);
+            }
+        }
+
+        std::vector<Instance> instances;
+
+        for (const auto& name : names)
+            if (auto* layout = openSegment(name))
+                instances.push_back({ name, layout });
+
+        return instances;
+    }
+
+    /** Retries a torn read a few times; a writer only holds a seqlock for a couple of microseconds. */
+    template<typename SeqLock, typename Payload>
+    bool readConsistent(const SeqLock& lock, Payload& payload)
+    {
+        for (int attempt = 0; attempt < 16; ++attempt)
+            if (lock.tryRead(payload))
+                return true;
+
+        return false;
+    }
+
+    float toDecibels(float gain) { return gain > 0.0f ? 20.0f * std::log10(gain) : -100.0f; }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && (std::strcmp(argv[1], "--help") == 0 || std::strcmp(argv[1], "-h") == 0))
+    {
+        std::printf("SharedSpectrumReader [--hz <refresh rate>] [%s<pid>-<n>...]\n", SharedSpectrumLayout::namePrefix);
+        std::printf("Start the host with PFM_PUBLISH_SPECTRA=1 so its instances publish.\n");
+        return 0;
+    }
+
+    auto hz = 4.0;
+    for (int i = 1; i + 1 < argc; ++i)
+        if (std::strcmp(argv[i], "--hz") == 0)
+            hz = std::max(0.1, std::atof(argv[i + 1]));
+
+    auto instances = findInstances(argc, argv);
+
+    if (instances.empty())
+    {
+        std::fprintf(stderr, "no analyzer instances are publishing\n");
+        return 1;
+    }
+
+    SharedSpectrumLayout::ChannelPayload payload;
+    SharedSpectrumLayout::AxisPayload axis;
+
+    for (;;)
+    {
+        for (const auto& instance : instances)
+        {
+            std::printf("%-28s", instance.name.c_str());
+
+            auto haveAxis = readConsistent(instance.layout->axis, axis);
+
+            for (uint32_t ch = 0; ch < instance.layout->numChannels; ++ch)
+            {
+                if (! readConsistent(instance.layout->channels[ch], payload) || payload.frameCount == 0)
+                {
+                    std::printf("  ch%u: -", ch);
+                    continue;
+                }
+
+                // the display point with the most energy, as a stand-in for whatever a dashboard would draw
+                auto numPoints = std::min(payload.numPoints, (uint32_t)SharedSpectrumLayout::maxPoints);
+                auto loudest = 0u;
+                for (auto p = 1u; p < numPoints; ++p)
+                    if (payload.levels[p] > payload.levels[loudest])
+                        loudest = p;
+
+                // a frame from before a re-prepare has a different axis; say nothing rather than the wrong frequency
+                auto frequency = haveAxis && axis.numPoints == payload.numPoints ? axis.pointFrequencies[loudest] : 0.0f;
+
+                std::printf("  ch%u: peak %6.1f dB  rms %6.1f dB  loudest %7.0f Hz  frame %lld", ch,
+                            toDecibels(payload.peak), toDecibels(payload.rms),
+                            frequency, (long long)payload.frameCount);
+            }
+
+            std::printf("\n");
+        }
+
+        std::printf("\n");
+        std::fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::duration<double>(1.0 / hz));
+    }
+}